@@ -0,0 +1,27 @@
+//*****************************************************************************
+//
+// clock_if.c
+//
+// Millisecond time base built on the CC3200 32.768 kHz slow clock counter,
+// which runs without any setup.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#include "hw_types.h"
+#include "prcm.h"
+#include "rom_map.h"
+
+#include "clock_if.h"
+
+unsigned long ClockGetMs(void)
+{
+    unsigned long long ullTicks = MAP_PRCMSlowClkCtrGet();
+
+    return (unsigned long)((ullTicks * 1000) >> 15);
+}
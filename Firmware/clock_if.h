@@ -0,0 +1,42 @@
+//*****************************************************************************
+//
+// clock_if.h
+//
+// Millisecond time base for measuring capture and network performance.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef _CLOCK_IF_H_
+#define _CLOCK_IF_H_
+
+
+//*****************************************************************************
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+extern unsigned long ClockGetMs(void);
+
+
+//*****************************************************************************
+// Mark the end of the C bindings section for C++ compilers.
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CLOCK_IF_H_ */
@@ -0,0 +1,59 @@
+//*****************************************************************************
+//
+// frame_info.h
+//
+// Per-frame metadata sent to the server along with the image, so it can
+// tell lost frames from its sequence number and see where a frame's time
+// went from the device timestamps.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef _FRAME_INFO_H_
+#define _FRAME_INFO_H_
+
+
+//*****************************************************************************
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+//*****************************************************************************
+// Defines
+//*****************************************************************************
+#define FRAME_FLAG_MOTION                   0x01    // Captured after motion
+
+
+//*****************************************************************************
+// Types
+//*****************************************************************************
+// Timestamps are ClockGetMs() on the device, 0 when not known yet
+typedef struct
+{
+    unsigned int uiSeq;
+    unsigned long ulCaptureStart;   // Snapshot requested from the camera
+    unsigned long ulLengthRead;     // Frame frozen and its length known
+    unsigned long ulReadDone;       // Last byte read over the UART
+    unsigned long ulPrevSent;       // Previous frame completely sent
+    unsigned char ucFlags;
+} tFrameInfo;
+
+
+//*****************************************************************************
+// Mark the end of the C bindings section for C++ compilers.
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRAME_INFO_H_ */
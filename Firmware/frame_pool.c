@@ -0,0 +1,81 @@
+//*****************************************************************************
+//
+// frame_pool.c
+//
+// Fixed pool of frame buffers carved out of one static block. Free buffers
+// are kept in an osi message queue, so acquire and release are safe from
+// different tasks and an empty pool can be waited on.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#include <stddef.h>
+#include "hw_types.h"
+#include "osi.h"
+
+#include "frame_pool.h"
+
+
+//*****************************************************************************
+// Variables
+//*****************************************************************************
+static OsiMsgQ_t _FreeMsgQ;
+static unsigned int _uiBufSize;
+
+
+//*****************************************************************************
+// Function Implementations
+//*****************************************************************************
+tBoolean FramePoolInit(unsigned char *pucMem, unsigned int uiNumBufs,
+                       unsigned int uiBufSize)
+{
+    unsigned char *pucBuf;
+    unsigned int i;
+
+    _uiBufSize = uiBufSize;
+
+    if(osi_MsgQCreate(&_FreeMsgQ, "FramePool", sizeof(unsigned char *),
+                      uiNumBufs) != OSI_OK)
+    {
+        return 0;
+    }
+
+    for(i=0; i<uiNumBufs; i++)
+    {
+        pucBuf = pucMem + i*uiBufSize;
+        if(osi_MsgQWrite(&_FreeMsgQ, &pucBuf, OSI_NO_WAIT) != OSI_OK)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+unsigned char *FramePoolAcquire(unsigned long ulTimeoutMs)
+{
+    unsigned char *pucBuf;
+
+    if(osi_MsgQRead(&_FreeMsgQ, &pucBuf, ulTimeoutMs) != OSI_OK)
+    {
+        return NULL;
+    }
+
+    return pucBuf;
+}
+
+void FramePoolRelease(unsigned char *pucBuf)
+{
+    // Never blocks, the queue has room for every buffer of the pool
+    osi_MsgQWrite(&_FreeMsgQ, &pucBuf, OSI_NO_WAIT);
+}
+
+unsigned int FramePoolGetBufSize(void)
+{
+    return _uiBufSize;
+}
@@ -0,0 +1,46 @@
+//*****************************************************************************
+//
+// frame_pool.h
+//
+// Fixed pool of preallocated frame buffers.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef _FRAME_POOL_H_
+#define _FRAME_POOL_H_
+
+
+//*****************************************************************************
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+extern tBoolean FramePoolInit(unsigned char *pucMem, unsigned int uiNumBufs,
+                              unsigned int uiBufSize);
+extern unsigned char *FramePoolAcquire(unsigned long ulTimeoutMs);
+extern void FramePoolRelease(unsigned char *pucBuf);
+extern unsigned int FramePoolGetBufSize(void);
+
+
+//*****************************************************************************
+// Mark the end of the C bindings section for C++ compilers.
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRAME_POOL_H_ */
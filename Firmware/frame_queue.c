@@ -0,0 +1,98 @@
+//*****************************************************************************
+//
+// frame_queue.c
+//
+// Frame queue on top of an osi message queue. A full queue drops its oldest
+// frame, so the network always sends the most recent frames and the camera
+// never waits on the network.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#include "hw_types.h"
+#include "osi.h"
+#include "frame_info.h"
+
+#include "frame_queue.h"
+
+
+//*****************************************************************************
+// Variables
+//*****************************************************************************
+static OsiMsgQ_t _FrameMsgQ;
+static tFrameRelease _pfnRelease;
+
+// Each counter has a single writer, so no locking is needed
+static unsigned int _uiDepth;
+static unsigned int _uiMaxQueued;
+static volatile unsigned int _uiEnqueued;   // Producer
+static volatile unsigned int _uiDropped;    // Producer
+static volatile unsigned int _uiDequeued;   // Consumer
+
+
+//*****************************************************************************
+// Function Implementations
+//*****************************************************************************
+tBoolean FrameQueueInit(unsigned int uiDepth, tFrameRelease pfnRelease)
+{
+    _uiDepth = uiDepth;
+    _pfnRelease = pfnRelease;
+    _uiMaxQueued = 0;
+    _uiEnqueued = 0;
+    _uiDropped = 0;
+    _uiDequeued = 0;
+
+    return osi_MsgQCreate(&_FrameMsgQ, "FrameQueue", sizeof(tFrame),
+                          uiDepth) == OSI_OK;
+}
+
+void FrameQueuePut(tFrame *psFrame)
+{
+    tFrame sOldest;
+    unsigned int uiQueued;
+
+    while(osi_MsgQWrite(&_FrameMsgQ, psFrame, OSI_NO_WAIT) != OSI_OK)
+    {
+        // Full, drop the oldest frame. The consumer may have taken it in the
+        // meantime, in which case there is room now.
+        if(osi_MsgQRead(&_FrameMsgQ, &sOldest, OSI_NO_WAIT) == OSI_OK)
+        {
+            _pfnRelease(&sOldest);
+            _uiDropped++;
+        }
+    }
+    _uiEnqueued++;
+
+    uiQueued = _uiEnqueued - _uiDropped - _uiDequeued;
+    if(uiQueued > _uiMaxQueued)
+    {
+        _uiMaxQueued = uiQueued;
+    }
+}
+
+tBoolean FrameQueueGet(tFrame *psFrame, unsigned long ulTimeoutMs)
+{
+    if(osi_MsgQRead(&_FrameMsgQ, psFrame, ulTimeoutMs) != OSI_OK)
+    {
+        return 0;
+    }
+    _uiDequeued++;
+
+    return 1;
+}
+
+void FrameQueueGetStats(tFrameQueueStats *psStats)
+{
+    psStats->uiDepth = _uiDepth;
+    psStats->uiEnqueued = _uiEnqueued;
+    psStats->uiDropped = _uiDropped;
+    psStats->uiDequeued = _uiDequeued;
+    psStats->uiQueued = psStats->uiEnqueued - psStats->uiDropped -
+                        psStats->uiDequeued;
+    psStats->uiMaxQueued = _uiMaxQueued;
+}
@@ -0,0 +1,72 @@
+//*****************************************************************************
+//
+// frame_queue.h
+//
+// Queue of captured frames between the camera capture task and the network
+// send task.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef _FRAME_QUEUE_H_
+#define _FRAME_QUEUE_H_
+
+
+//*****************************************************************************
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+//*****************************************************************************
+// Types
+//*****************************************************************************
+// Frame descriptor, the image itself is not copied into the queue
+typedef struct
+{
+    unsigned char *pucBuf;
+    unsigned int uiLen;
+    tFrameInfo sInfo;
+} tFrame;
+
+// Called for frames dropped from a full queue, so their buffer is freed
+typedef void (*tFrameRelease)(tFrame *psFrame);
+
+typedef struct
+{
+    unsigned int uiDepth;
+    unsigned int uiQueued;          // Frames in the queue right now
+    unsigned int uiMaxQueued;       // High water mark
+    unsigned int uiEnqueued;
+    unsigned int uiDequeued;
+    unsigned int uiDropped;
+} tFrameQueueStats;
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+extern tBoolean FrameQueueInit(unsigned int uiDepth,
+                               tFrameRelease pfnRelease);
+extern void FrameQueuePut(tFrame *psFrame);
+extern tBoolean FrameQueueGet(tFrame *psFrame, unsigned long ulTimeoutMs);
+extern void FrameQueueGetStats(tFrameQueueStats *psStats);
+
+
+//*****************************************************************************
+// Mark the end of the C bindings section for C++ compilers.
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRAME_QUEUE_H_ */
@@ -0,0 +1,186 @@
+//*****************************************************************************
+//
+// frame_stream.c
+//
+// Sends frames over a TCP connection that is kept open between frames, so a
+// frame costs no request, handshake or new socket on either side. Each frame
+// is a small header followed by the JPEG data. The connection is made on the
+// first frame and made again on the next frame after an error.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#include "hw_types.h"
+#include "simplelink.h"
+#include "frame_info.h"
+
+#include "frame_stream.h"
+
+
+//*****************************************************************************
+// Defines
+//*****************************************************************************
+#define _FRAME_STREAM_MAX_SEND              1460    // Largest sl_Send()
+
+
+//*****************************************************************************
+// Variables
+//*****************************************************************************
+static short _sSocket = -1;
+static SlSockAddrIn_t _sServerAddr;
+static unsigned int _uiFrameLeft;           // Bytes of the frame to send
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+static tBoolean _FrameStreamConnect(void);
+static tBoolean _FrameStreamSend(const unsigned char *pucBuf,
+                                 unsigned int uiLen);
+static unsigned int _FrameStreamPut32(unsigned char *pucBuf,
+                                      unsigned long ulValue);
+
+
+//*****************************************************************************
+// Function Implementations
+//*****************************************************************************
+void FrameStreamInit(unsigned long ulServerIP, unsigned short usServerPort)
+{
+    FrameStreamClose();
+
+    _sServerAddr.sin_family = SL_AF_INET;
+    _sServerAddr.sin_port = sl_Htons(usServerPort);
+    _sServerAddr.sin_addr.s_addr = sl_Htonl(ulServerIP);
+}
+
+tBoolean FrameStreamBegin(unsigned int uiFrameLen, const tFrameInfo *psInfo)
+{
+    unsigned char ucHeader[FRAME_STREAM_HEADER_SIZE];
+    unsigned int uiLen = 0;
+
+    ucHeader[uiLen++] = FRAME_STREAM_MAGIC_0;
+    ucHeader[uiLen++] = FRAME_STREAM_MAGIC_1;
+    ucHeader[uiLen++] = FRAME_STREAM_VERSION;
+    ucHeader[uiLen++] = FRAME_STREAM_HEADER_SIZE;
+    uiLen += _FrameStreamPut32(ucHeader+uiLen, psInfo->uiSeq);
+    uiLen += _FrameStreamPut32(ucHeader+uiLen, uiFrameLen);
+    uiLen += _FrameStreamPut32(ucHeader+uiLen, psInfo->ulCaptureStart);
+    uiLen += _FrameStreamPut32(ucHeader+uiLen, psInfo->ulLengthRead);
+    uiLen += _FrameStreamPut32(ucHeader+uiLen, psInfo->ulReadDone);
+    uiLen += _FrameStreamPut32(ucHeader+uiLen, psInfo->ulPrevSent);
+    ucHeader[uiLen++] = psInfo->ucFlags;
+
+    // The previous frame was cut short, the server can't find the next
+    // header in this connection any more
+    if((_sSocket >= 0) && (_uiFrameLeft > 0))
+    {
+        FrameStreamClose();
+    }
+
+    if((_sSocket < 0) && !_FrameStreamConnect())
+    {
+        return 0;
+    }
+
+    _uiFrameLeft = uiFrameLen;
+
+    return _FrameStreamSend(ucHeader, uiLen);
+}
+
+tBoolean FrameStreamWrite(const unsigned char *pucBuf, unsigned int uiLen)
+{
+    if((_sSocket < 0) || (uiLen > _uiFrameLeft))
+    {
+        return 0;
+    }
+
+    if(!_FrameStreamSend(pucBuf, uiLen))
+    {
+        return 0;
+    }
+
+    _uiFrameLeft -= uiLen;
+
+    return 1;
+}
+
+tBoolean FrameStreamSend(const unsigned char *pucBuf, unsigned int uiLen,
+                         const tFrameInfo *psInfo)
+{
+    return FrameStreamBegin(uiLen, psInfo) && FrameStreamWrite(pucBuf, uiLen);
+}
+
+void FrameStreamClose(void)
+{
+    if(_sSocket >= 0)
+    {
+        sl_Close(_sSocket);
+        _sSocket = -1;
+    }
+
+    _uiFrameLeft = 0;
+}
+
+static tBoolean _FrameStreamConnect(void)
+{
+    _sSocket = sl_Socket(SL_AF_INET, SL_SOCK_STREAM, SL_IPPROTO_TCP);
+    if(_sSocket < 0)
+    {
+        return 0;
+    }
+
+    if(sl_Connect(_sSocket, (SlSockAddr_t *)&_sServerAddr,
+                  sizeof(SlSockAddrIn_t)) < 0)
+    {
+        FrameStreamClose();
+        return 0;
+    }
+
+    return 1;
+}
+
+static tBoolean _FrameStreamSend(const unsigned char *pucBuf,
+                                 unsigned int uiLen)
+{
+    unsigned int uiSendLen;
+    short sSent;
+
+    while(uiLen > 0)
+    {
+        uiSendLen = uiLen;
+        if(uiSendLen > _FRAME_STREAM_MAX_SEND)
+        {
+            uiSendLen = _FRAME_STREAM_MAX_SEND;
+        }
+
+        // Blocks until the data is buffered, may take less than asked
+        sSent = sl_Send(_sSocket, pucBuf, uiSendLen, 0);
+        if(sSent <= 0)
+        {
+            // Reconnected on the next frame
+            FrameStreamClose();
+            return 0;
+        }
+
+        pucBuf += sSent;
+        uiLen -= sSent;
+    }
+
+    return 1;
+}
+
+static unsigned int _FrameStreamPut32(unsigned char *pucBuf,
+                                      unsigned long ulValue)
+{
+    pucBuf[0] = (ulValue >> 24) & 0xFF;
+    pucBuf[1] = (ulValue >> 16) & 0xFF;
+    pucBuf[2] = (ulValue >> 8) & 0xFF;
+    pucBuf[3] = ulValue & 0xFF;
+
+    return 4;
+}
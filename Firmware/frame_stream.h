@@ -0,0 +1,69 @@
+//*****************************************************************************
+//
+// frame_stream.h
+//
+// API for sending frames to the server over one long-lived TCP connection,
+// instead of a TFTP session per frame.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef _FRAME_STREAM_H_
+#define _FRAME_STREAM_H_
+
+
+//*****************************************************************************
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+//*****************************************************************************
+// Defines
+//*****************************************************************************
+#define FRAME_STREAM_PORT                   6066
+#define FRAME_STREAM_VERSION                2
+
+// Every frame is preceded by a header, multi-byte fields are big endian:
+//   'V' 'S' version header_length sequence(4) frame_length(4)
+// Version 2 appends the device timestamps of tFrameInfo and its flags:
+//   capture_start(4) length_read(4) read_done(4) prev_sent(4) flags(1)
+// A receiver skips header bytes it does not know, so later versions can
+// append fields.
+#define FRAME_STREAM_MAGIC_0                'V'
+#define FRAME_STREAM_MAGIC_1                'S'
+#define FRAME_STREAM_HEADER_SIZE            29
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+extern void FrameStreamInit(unsigned long ulServerIP,
+                            unsigned short usServerPort);
+extern tBoolean FrameStreamBegin(unsigned int uiFrameLen,
+                                 const tFrameInfo *psInfo);
+extern tBoolean FrameStreamWrite(const unsigned char *pucBuf,
+                                 unsigned int uiLen);
+extern tBoolean FrameStreamSend(const unsigned char *pucBuf,
+                                unsigned int uiLen,
+                                const tFrameInfo *psInfo);
+extern void FrameStreamClose(void);
+
+
+//*****************************************************************************
+// Mark the end of the C bindings section for C++ compilers.
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRAME_STREAM_H_ */
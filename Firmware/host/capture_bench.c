@@ -0,0 +1,419 @@
+//*****************************************************************************
+//
+// capture_bench.c
+//
+// Capture path benchmark on a host, against the simulated VC0706 of
+// vc0706_sim.c. For every image size and baud rate it initializes the
+// camera as the firmware does and checks that a snapshot comes back
+// intact. Then, for every capture mode, read control mode and compression
+// ratio, it times CameraSnapshot() across read chunk sizes with
+// CameraBenchmarkReadMode() and prints the best chunk size, or all of them
+// with -a. Times are simulated, so results only change when the driver or
+// the camera model does.
+//
+// Usage: capture_bench [-a] [-n frames] [-d command_delay_us]
+//                      [-p frame_period_us] [WxH:file.jpg ...]
+//
+// Without files, frames of typical sizes for each resolution are made up.
+// Exits with 1 if a snapshot is corrupt or a capture fails.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hw_types.h"
+#include "vc0706.h"
+#include "vc0706_if.h"
+#include "vc0706_sim.h"
+
+
+//*****************************************************************************
+// Defines
+//*****************************************************************************
+#define BENCH_DEFAULT_FRAMES        10
+#define BENCH_MAX_IMAGES            8
+
+
+//*****************************************************************************
+// Types
+//*****************************************************************************
+typedef struct
+{
+    const char *pcName;
+    unsigned char ucImageSize;
+    unsigned int uiSyntheticLen;    // Typical frame at default compression
+} tBenchSize;
+
+typedef struct
+{
+    const char *pcName;
+    unsigned char ucValue;
+} tBenchMode;
+
+typedef struct
+{
+    const char *pcSource;
+    unsigned char ucImageSize;
+    unsigned char *pucData;
+    unsigned int uiLen;
+} tBenchImage;
+
+
+//*****************************************************************************
+// Variables
+//*****************************************************************************
+static const tBenchSize g_sSizes[] =
+{
+    {"640x480", VC0706_IMAGE_SIZE_640_480, 48 * 1024},
+    {"320x240", VC0706_IMAGE_SIZE_320_240, 12 * 1024},
+    {"160x120", VC0706_IMAGE_SIZE_160_120, 3 * 1024}
+};
+#define NUM_SIZES           (sizeof(g_sSizes)/sizeof(g_sSizes[0]))
+
+// Rates CameraNegotiateBaudRate() can reach from the camera's default
+static const unsigned long g_ulBaudRates[] = {38400, 57600, 115200};
+#define NUM_BAUD_RATES      (sizeof(g_ulBaudRates)/sizeof(g_ulBaudRates[0]))
+
+static const unsigned int g_uiChunkSizes[] = {32, 64, 128, 256, 512, 1024,
+                                              4096, 0};
+#define NUM_CHUNK_SIZES     (sizeof(g_uiChunkSizes)/sizeof(g_uiChunkSizes[0]))
+
+static const tBenchMode g_sCaptureModes[] =
+{
+    {"stop", CAMERA_CAPTURE_STOP_RESUME},
+    {"step", CAMERA_CAPTURE_STEP},
+    {"next", CAMERA_CAPTURE_NEXT_FRAME}
+};
+#define NUM_CAPTURE_MODES   (sizeof(g_sCaptureModes)/sizeof(g_sCaptureModes[0]))
+
+static const tBenchMode g_sCtrlModes[] =
+{
+    {"mcu", VC0706_CONTROL_MODE_MCU},
+    {"dma", VC0706_CONTROL_MODE_DMA}
+};
+#define NUM_CTRL_MODES      (sizeof(g_sCtrlModes)/sizeof(g_sCtrlModes[0]))
+
+// The compression steps of the firmware's rate control ladder
+static const unsigned char g_ucCompressions[] = {0x28,
+                                                 VC0706_COMPRESSION_DEFAULT,
+                                                 0x60};
+#define NUM_COMPRESSIONS    (sizeof(g_ucCompressions) / \
+                             sizeof(g_ucCompressions[0]))
+
+static tBenchImage g_sImages[BENCH_MAX_IMAGES];
+static unsigned int g_uiNumImages;
+static tBoolean g_bAllChunks;
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+static const tBenchSize *BenchFindSize(const char *pcName);
+static tBoolean BenchLoadImage(const char *pcArg);
+static void BenchMakeImage(const tBenchSize *psSize);
+static int BenchRun(const tBenchImage *psImage,
+                    const tVC0706SimConfig *psConfig,
+                    unsigned int uiFrames);
+static int BenchModes(const tBenchImage *psImage, unsigned long ulBaudRate,
+                      unsigned int uiFrames, unsigned char *pucBuf);
+static void Usage(const char *pcProg);
+
+
+//*****************************************************************************
+// Function Implementations
+//*****************************************************************************
+int main(int argc, char **argv)
+{
+    tVC0706SimConfig sConfig;
+    unsigned int uiFrames = BENCH_DEFAULT_FRAMES;
+    int iFailed = 0;
+    unsigned int i;
+    int iOpt;
+
+    sConfig.ulCommandDelayUs = VC0706_SIM_DEFAULT_COMMAND_DELAY_US;
+    sConfig.ulFramePeriodUs = VC0706_SIM_DEFAULT_FRAME_PERIOD_US;
+
+    while((iOpt = getopt(argc, argv, "an:d:p:")) != -1)
+    {
+        switch(iOpt)
+        {
+        case 'a':
+            g_bAllChunks = 1;
+            break;
+        case 'n':
+            uiFrames = strtoul(optarg, 0, 0);
+            break;
+        case 'd':
+            sConfig.ulCommandDelayUs = strtoul(optarg, 0, 0);
+            break;
+        case 'p':
+            sConfig.ulFramePeriodUs = strtoul(optarg, 0, 0);
+            break;
+        default:
+            Usage(argv[0]);
+            return 2;
+        }
+    }
+
+    for(; optind < argc; optind++)
+    {
+        if(!BenchLoadImage(argv[optind]))
+        {
+            Usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if(g_uiNumImages == 0)
+    {
+        for(i=0; i<NUM_SIZES; i++)
+        {
+            BenchMakeImage(&g_sSizes[i]);
+        }
+    }
+
+    printf("# command delay %lu us, frame period %lu us, %u frames per row\n",
+           sConfig.ulCommandDelayUs, sConfig.ulFramePeriodUs, uiFrames);
+    printf("%-24s %7s %-4s %-4s %4s %6s %6s %9s %8s %7s %9s\n", "image",
+           "baud", "mode", "ctrl", "comp", "chunk", "frames", "bytes", "ms",
+           "fps", "bytes/s");
+
+    for(i=0; i<g_uiNumImages; i++)
+    {
+        iFailed |= BenchRun(&g_sImages[i], &sConfig, uiFrames);
+    }
+
+    return iFailed;
+}
+
+static const tBenchSize *BenchFindSize(const char *pcName)
+{
+    unsigned int i;
+
+    for(i=0; i<NUM_SIZES; i++)
+    {
+        if(strcmp(g_sSizes[i].pcName, pcName) == 0)
+        {
+            return &g_sSizes[i];
+        }
+    }
+
+    return 0;
+}
+
+static tBoolean BenchLoadImage(const char *pcArg)
+{
+    const tBenchSize *psSize;
+    const char *pcPath = strchr(pcArg, ':');
+    char cName[16];
+    tBenchImage *psImage;
+    FILE *pFile;
+    long lLen;
+
+    if(!pcPath || (pcPath - pcArg >= (long)sizeof(cName)) ||
+       (g_uiNumImages == BENCH_MAX_IMAGES))
+    {
+        return 0;
+    }
+    memcpy(cName, pcArg, pcPath - pcArg);
+    cName[pcPath - pcArg] = '\0';
+    pcPath++;
+
+    psSize = BenchFindSize(cName);
+    if(!psSize)
+    {
+        fprintf(stderr, "Unknown image size %s\n", cName);
+        return 0;
+    }
+
+    pFile = fopen(pcPath, "rb");
+    if(!pFile)
+    {
+        perror(pcPath);
+        return 0;
+    }
+    fseek(pFile, 0, SEEK_END);
+    lLen = ftell(pFile);
+    fseek(pFile, 0, SEEK_SET);
+
+    psImage = &g_sImages[g_uiNumImages];
+    psImage->pucData = malloc(lLen > 0 ? lLen : 1);
+    if((lLen <= 0) || (fread(psImage->pucData, 1, lLen, pFile) != (size_t)lLen))
+    {
+        fprintf(stderr, "Cannot read %s\n", pcPath);
+        fclose(pFile);
+        return 0;
+    }
+    fclose(pFile);
+
+    psImage->pcSource = pcArg;
+    psImage->ucImageSize = psSize->ucImageSize;
+    psImage->uiLen = lLen;
+    g_uiNumImages++;
+
+    return 1;
+}
+
+static void BenchMakeImage(const tBenchSize *psSize)
+{
+    tBenchImage *psImage = &g_sImages[g_uiNumImages++];
+    unsigned int uiSeed = psSize->uiSyntheticLen;
+    unsigned int i;
+
+    // Only the length matters to the capture path, the bytes just have to
+    // look like a JPEG at both ends
+    psImage->pcSource = psSize->pcName;
+    psImage->ucImageSize = psSize->ucImageSize;
+    psImage->uiLen = psSize->uiSyntheticLen;
+    psImage->pucData = malloc(psImage->uiLen);
+    for(i=0; i<psImage->uiLen; i++)
+    {
+        uiSeed = uiSeed * 1103515245 + 12345;
+        psImage->pucData[i] = uiSeed >> 16;
+    }
+    psImage->pucData[0] = 0xFF;
+    psImage->pucData[1] = 0xD8;
+    psImage->pucData[psImage->uiLen - 2] = 0xFF;
+    psImage->pucData[psImage->uiLen - 1] = 0xD9;
+}
+
+static int BenchRun(const tBenchImage *psImage,
+                    const tVC0706SimConfig *psConfig,
+                    unsigned int uiFrames)
+{
+    tVC0706SimStats sStats;
+    unsigned char *pucBuf;
+    unsigned int uiFrameLen;
+    int iFailed = 0;
+    unsigned int i;
+
+    // Lower compression ratios make frames larger than the image
+    pucBuf = malloc(VC0706_SIM_MAX_FRAME_SIZE);
+
+    for(i=0; i<NUM_BAUD_RATES; i++)
+    {
+        // Power cycle, so every row starts from the camera's default rate
+        VC0706SimPowerOn(psConfig);
+        VC0706SimAddImage(psImage->ucImageSize, psImage->pucData,
+                          psImage->uiLen);
+
+        if(!CameraInit(CAMERA_DEFAULT_SERIAL_NUM, g_ulBaudRates[i],
+                       psImage->ucImageSize) ||
+           (CameraGetBaudRate() != g_ulBaudRates[i]))
+        {
+            printf("%-24s %7lu init failed\n", psImage->pcSource,
+                   g_ulBaudRates[i]);
+            iFailed = 1;
+            continue;
+        }
+
+        // The frame must arrive exactly as the camera holds it
+        if((CameraSnapshot(pucBuf, psImage->uiLen, &uiFrameLen) !=
+            CAMERA_STATUS_OK) || (uiFrameLen != psImage->uiLen) ||
+           memcmp(pucBuf, psImage->pucData, uiFrameLen))
+        {
+            printf("%-24s %7lu corrupt snapshot\n", psImage->pcSource,
+                   g_ulBaudRates[i]);
+            iFailed = 1;
+            continue;
+        }
+
+        iFailed |= BenchModes(psImage, g_ulBaudRates[i], uiFrames, pucBuf);
+
+        VC0706SimGetStats(&sStats);
+        if(sStats.ulErrors || sStats.ulTimeouts > CAMERA_BAUD_VERIFY_TRIES *
+           NUM_BAUD_RATES)
+        {
+            printf("# %lu camera errors, %lu timeouts\n", sStats.ulErrors,
+                   sStats.ulTimeouts);
+        }
+    }
+
+    free(pucBuf);
+
+    return iFailed;
+}
+
+static int BenchModes(const tBenchImage *psImage, unsigned long ulBaudRate,
+                      unsigned int uiFrames, unsigned char *pucBuf)
+{
+    tCameraBenchResult sResults[NUM_CHUNK_SIZES];
+    unsigned int uiBest;
+    unsigned long ulMs;
+    int iFailed = 0;
+    unsigned int i, j, k, l;
+
+    for(i=0; i<NUM_CAPTURE_MODES; i++)
+    {
+        CameraSetCaptureMode(g_sCaptureModes[i].ucValue);
+
+        for(j=0; j<NUM_CTRL_MODES; j++)
+        {
+            for(k=0; k<NUM_COMPRESSIONS; k++)
+            {
+                if(!CameraSetQuality(VC0706_DOWNSIZE_1_1,
+                                     g_ucCompressions[k]))
+                {
+                    printf("%-24s %7lu compression 0x%02X failed\n",
+                           psImage->pcSource, ulBaudRate,
+                           g_ucCompressions[k]);
+                    iFailed = 1;
+                    continue;
+                }
+
+                uiBest = CameraBenchmarkReadMode(g_uiChunkSizes,
+                                                 NUM_CHUNK_SIZES,
+                                                 g_sCtrlModes[j].ucValue,
+                                                 uiFrames, pucBuf,
+                                                 VC0706_SIM_MAX_FRAME_SIZE,
+                                                 sResults);
+
+                for(l=0; l<NUM_CHUNK_SIZES; l++)
+                {
+                    if(sResults[l].uiFrames != uiFrames)
+                    {
+                        iFailed = 1;
+                    }
+                    else if(!g_bAllChunks && (l != uiBest))
+                    {
+                        continue;
+                    }
+
+                    ulMs = sResults[l].ulElapsedMs ?
+                           sResults[l].ulElapsedMs : 1;
+                    printf("%-24s %7lu %-4s %-4s 0x%02X %6u %6u %9lu %8lu "
+                           "%7.2f %9lu%s\n", psImage->pcSource, ulBaudRate,
+                           g_sCaptureModes[i].pcName, g_sCtrlModes[j].pcName,
+                           g_ucCompressions[k], sResults[l].uiChunkSize,
+                           sResults[l].uiFrames, sResults[l].ulBytes,
+                           sResults[l].ulElapsedMs,
+                           sResults[l].uiFrames * 1000.0 / ulMs,
+                           sResults[l].ulBytes * 1000 / ulMs,
+                           l == uiBest ? " *" : "");
+                }
+            }
+        }
+    }
+
+    // The driver keeps these across CameraInit(), the next row starts over
+    CameraSetQuality(VC0706_DOWNSIZE_1_1, VC0706_COMPRESSION_DEFAULT);
+    CameraSetCaptureMode(CAMERA_DEFAULT_CAPTURE_MODE);
+
+    return iFailed;
+}
+
+static void Usage(const char *pcProg)
+{
+    fprintf(stderr, "Usage: %s [-a] [-n frames] [-d command_delay_us] "
+            "[-p frame_period_us] [WxH:file.jpg ...]\n"
+            "  WxH is one of 640x480, 320x240, 160x120\n"
+            "  -a prints every chunk size, not just the best\n", pcProg);
+}
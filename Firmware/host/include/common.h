@@ -0,0 +1,19 @@
+//*****************************************************************************
+//
+// common.h
+//
+// Host build stand-in for the CC3200 SDK header of the same name. Empty, the
+// driver uses nothing from it.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef __HOST_COMMON_H__
+#define __HOST_COMMON_H__
+
+#endif /* __HOST_COMMON_H__ */
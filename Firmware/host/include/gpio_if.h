@@ -0,0 +1,26 @@
+//*****************************************************************************
+//
+// gpio_if.h
+//
+// Host build stand-in for the CC3200 SDK header of the same name. The LEDs
+// are not modelled, so they are never lit.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef __HOST_GPIO_IF_H__
+#define __HOST_GPIO_IF_H__
+
+#define MCU_RED_LED_GPIO                        9
+#define MCU_ORANGE_LED_GPIO                     10
+#define MCU_GREEN_LED_GPIO                      11
+
+#define GPIO_IF_LedOn(ucLedNum)                 ((void)(ucLedNum))
+#define GPIO_IF_LedOff(ucLedNum)                ((void)(ucLedNum))
+
+#endif /* __HOST_GPIO_IF_H__ */
@@ -0,0 +1,24 @@
+//*****************************************************************************
+//
+// hw_types.h
+//
+// Host build stand-in for the CC3200 SDK header of the same name. Only the
+// types the camera driver uses.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef __HOST_HW_TYPES_H__
+#define __HOST_HW_TYPES_H__
+
+#define true                                    1
+#define false                                   0
+
+typedef unsigned char tBoolean;
+
+#endif /* __HOST_HW_TYPES_H__ */
@@ -0,0 +1,25 @@
+//*****************************************************************************
+//
+// osi.h
+//
+// Host build stand-in for the CC3200 SDK header of the same name. Sleeping
+// advances the simulated clock, see vc0706_sim.c.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef __HOST_OSI_H__
+#define __HOST_OSI_H__
+
+#define OSI_OK                                  0
+
+typedef int OsiReturnVal_e;
+
+extern void osi_Sleep(unsigned int MilliSecs);
+
+#endif /* __HOST_OSI_H__ */
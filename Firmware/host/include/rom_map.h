@@ -0,0 +1,19 @@
+//*****************************************************************************
+//
+// rom_map.h
+//
+// Host build stand-in for the CC3200 SDK header of the same name. Empty, the
+// driver makes no ROM calls outside the UART.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef __HOST_ROM_MAP_H__
+#define __HOST_ROM_MAP_H__
+
+#endif /* __HOST_ROM_MAP_H__ */
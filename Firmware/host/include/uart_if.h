@@ -0,0 +1,19 @@
+//*****************************************************************************
+//
+// uart_if.h
+//
+// Host build stand-in for the CC3200 SDK header of the same name. Empty, the
+// driver prints nothing to the console.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef __HOST_UART_IF_H__
+#define __HOST_UART_IF_H__
+
+#endif /* __HOST_UART_IF_H__ */
@@ -0,0 +1,19 @@
+//*****************************************************************************
+//
+// utils.h
+//
+// Host build stand-in for the CC3200 SDK header of the same name. Empty, the
+// driver does not busy-wait.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef __HOST_UTILS_H__
+#define __HOST_UTILS_H__
+
+#endif /* __HOST_UTILS_H__ */
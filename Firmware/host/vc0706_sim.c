@@ -0,0 +1,778 @@
+//*****************************************************************************
+//
+// vc0706_sim.c
+//
+// Simulated VC0706 Serial Camera Module, see vc0706_sim.h.
+//
+// Commands written to the UART are parsed as the camera would, and each
+// response is queued as segments of bytes with the simulated time their
+// first byte leaves the camera. The camera's transmit line is serial, so a
+// segment never starts before the previous one ends. A read takes bytes in
+// order and moves the clock to the arrival of each, or by the timeout when
+// the camera has nothing more to say.
+//
+// The sensor runs freely at the frame period. The current-frame buffer
+// needs a whole period to fill after a RESUME or STEP, the next-frame
+// buffer is frozen at the next frame the sensor completes. Frames are the
+// added images scaled in length by the compression ratio, relative to
+// VC0706_COMPRESSION_DEFAULT. READ_FBUF in MCU mode waits the requested
+// delay before the data, in DMA mode the data follows the header at once.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#include <string.h>
+#include "hw_types.h"
+#include "osi.h"
+#include "vc0706.h"
+#include "vc0706_uart.h"
+#include "clock_if.h"
+
+#include "vc0706_sim.h"
+
+
+//*****************************************************************************
+// Defines
+//*****************************************************************************
+#define _SIM_NUM_SIZES              3       // 640x480, 320x240, 160x120
+#define _SIM_MAX_SEGMENTS           8
+#define _SIM_INLINE_SIZE            16
+#define _SIM_CMD_HEADER_SIZE        4       // Sign, serial, command, length
+#define _SIM_BITS_PER_BYTE          10      // Start, 8 data, stop
+#define _SIM_NS_PER_MS              1000000ULL
+#define _SIM_FBUF_DELAY_NS          10000ULL    // READ_FBUF delay unit
+#define _SIM_REG_IMAGE_SIZE         0x0019
+#define _SIM_REG_COMPRESSION        0x1204
+#define _SIM_MIN_FRAME_SIZE         4       // SOI and EOI markers
+#define _SIM_VERSION                "VC0703 1.00"
+
+
+//*****************************************************************************
+// Types
+//*****************************************************************************
+typedef struct
+{
+    const unsigned char *pucData;           // 0 for ucInline
+    unsigned char ucInline[_SIM_INLINE_SIZE];
+    unsigned int uiLen;
+    unsigned int uiPos;
+    unsigned long ulBaudRate;               // Rate it was sent at
+    unsigned long long ullStartNs;
+} tSimSegment;
+
+typedef struct
+{
+    const unsigned char *pucData;
+    unsigned int uiLen;
+} tSimImage;
+
+typedef struct
+{
+    unsigned char ucData[VC0706_SIM_MAX_FRAME_SIZE];
+    unsigned int uiLen;                     // 0 without an image
+    tBoolean bFrozen;
+    unsigned long long ullReadyNs;          // Frame complete
+} tSimFrameBuffer;
+
+typedef struct
+{
+    unsigned short usCameraBaud;
+    unsigned long ulBaudRate;
+} tSimBaudRate;
+
+
+//*****************************************************************************
+// Variables
+//*****************************************************************************
+static const tSimBaudRate _sBaudRates[] =
+{
+    {VC0706_INTERFACE_UART_BAUD_9600,   9600},
+    {VC0706_INTERFACE_UART_BAUD_19200,  19200},
+    {VC0706_INTERFACE_UART_BAUD_38400,  38400},
+    {VC0706_INTERFACE_UART_BAUD_57600,  57600},
+    {VC0706_INTERFACE_UART_BAUD_115200, 115200}
+};
+#define _NUM_BAUD_RATES     (sizeof(_sBaudRates)/sizeof(_sBaudRates[0]))
+
+static tVC0706SimConfig _sConfig;
+static tVC0706SimStats _sStats;
+static unsigned long long _ullNowNs;
+
+// Link
+static unsigned long _ulHostBaud;
+static unsigned long _ulCameraBaud;
+static unsigned long _ulNextCameraBaud;     // Taken once the ack is out
+static unsigned long long _ullBaudSwitchNs;
+static tSimSegment _sSegments[_SIM_MAX_SEGMENTS];
+static unsigned int _uiSegHead;
+static unsigned int _uiSegCount;
+static unsigned long long _ullTxFreeNs;     // Camera transmit line idle
+static unsigned char _ucCmdBuf[_SIM_CMD_HEADER_SIZE + 255];
+static unsigned int _uiCmdLen;
+
+// Camera
+static tSimImage _sImages[_SIM_NUM_SIZES][VC0706_SIM_MAX_IMAGES];
+static unsigned int _uiNumImages[_SIM_NUM_SIZES];
+static unsigned int _uiFrameCount;          // Frames the sensor took
+static unsigned long long _ullSensorStartNs;
+static tSimFrameBuffer _sFrameBufs[2];      // By frame type
+static unsigned char _ucImageSize;
+static unsigned char _ucDownsize;
+static unsigned char _ucCompression;
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+static unsigned long _SimCameraBaud(void);
+static unsigned long long _SimByteNs(unsigned long ulBaudRate);
+static int _SimSizeIndex(unsigned char ucImageSize);
+static void _SimNewFrame(tSimFrameBuffer *psBuf);
+static unsigned long long _SimNextSensorFrame(unsigned long long ullNs);
+static void _SimFrameControl(unsigned char ucCtrl,
+                             unsigned long long ullReadyNs);
+static void _SimFrameLength(unsigned long long ullReadyNs);
+static unsigned long long _SimSend(const unsigned char *pucData,
+                                   unsigned int uiLen,
+                                   unsigned long long ullEarliestNs);
+static unsigned long long _SimReply(unsigned char ucCmd,
+                                    unsigned char ucStatus,
+                                    const unsigned char *pucData,
+                                    unsigned char ucDataLen,
+                                    unsigned long long ullEarliestNs);
+static void _SimCommand(void);
+static void _SimDropArrived(void);
+static void _SimReadFrameBuffer(unsigned long long ullReadyNs);
+
+
+//*****************************************************************************
+// Function Implementations
+//*****************************************************************************
+void VC0706SimPowerOn(const tVC0706SimConfig *psConfig)
+{
+    if(psConfig)
+    {
+        _sConfig = *psConfig;
+    }
+    else
+    {
+        _sConfig.ulCommandDelayUs = VC0706_SIM_DEFAULT_COMMAND_DELAY_US;
+        _sConfig.ulFramePeriodUs = VC0706_SIM_DEFAULT_FRAME_PERIOD_US;
+    }
+
+    memset(&_sStats, 0, sizeof(_sStats));
+    memset(_uiNumImages, 0, sizeof(_uiNumImages));
+    _uiSegHead = _uiSegCount = 0;
+    _uiCmdLen = 0;
+    _ulCameraBaud = _ulNextCameraBaud = VC0706_DEFAULT_BAUD_RATE;
+    _ullTxFreeNs = _ullNowNs;
+    _uiFrameCount = 0;
+    _ullSensorStartNs = _ullNowNs;
+    memset(_sFrameBufs, 0, sizeof(_sFrameBufs));
+    _sFrameBufs[VC0706_CURRENT_FRAME].ullReadyNs =
+        _ullNowNs + _sConfig.ulFramePeriodUs * 1000ULL;
+    _ucImageSize = VC0706_IMAGE_SIZE_640_480;
+    _ucDownsize = 0;
+    _ucCompression = VC0706_COMPRESSION_DEFAULT;
+}
+
+tBoolean VC0706SimAddImage(unsigned char ucImageSize,
+                           const unsigned char *pucJpeg, unsigned int uiLen)
+{
+    int iSize = _SimSizeIndex(ucImageSize);
+
+    if((iSize < 0) || (_uiNumImages[iSize] == VC0706_SIM_MAX_IMAGES) ||
+       (uiLen < _SIM_MIN_FRAME_SIZE) || (uiLen > VC0706_SIM_MAX_FRAME_SIZE))
+    {
+        return 0;
+    }
+
+    _sImages[iSize][_uiNumImages[iSize]].pucData = pucJpeg;
+    _sImages[iSize][_uiNumImages[iSize]].uiLen = uiLen;
+    _uiNumImages[iSize]++;
+
+    return 1;
+}
+
+unsigned long VC0706SimGetBaudRate(void)
+{
+    return _SimCameraBaud();
+}
+
+void VC0706SimGetStats(tVC0706SimStats *psStats)
+{
+    *psStats = _sStats;
+}
+
+unsigned long long VC0706SimGetTimeUs(void)
+{
+    return _ullNowNs / 1000;
+}
+
+//*****************************************************************************
+// Clock and RTOS
+//*****************************************************************************
+unsigned long ClockGetMs(void)
+{
+    return (unsigned long)(_ullNowNs / _SIM_NS_PER_MS);
+}
+
+void osi_Sleep(unsigned int MilliSecs)
+{
+    _ullNowNs += MilliSecs * _SIM_NS_PER_MS;
+}
+
+//*****************************************************************************
+// UART, host side of the link
+//*****************************************************************************
+void VC0706UartInit(unsigned long ulBaudRate)
+{
+    VC0706UartSetBaudRate(ulBaudRate);
+}
+
+void VC0706UartSetBaudRate(unsigned long ulBaudRate)
+{
+    _ulHostBaud = ulBaudRate;
+}
+
+void VC0706UartWrite(const unsigned char *pucBuf, unsigned int uiLen)
+{
+    unsigned int uiNeed;
+
+    while(uiLen-- > 0)
+    {
+        _ullNowNs += _SimByteNs(_ulHostBaud);
+        _sStats.ulBytesToCamera++;
+
+        // At the wrong rate the camera only sees framing errors
+        if(_ulHostBaud != _SimCameraBaud())
+        {
+            _sStats.ulBaudMismatches++;
+            _uiCmdLen = 0;
+            pucBuf++;
+            continue;
+        }
+
+        // Resynchronize on the start of a command
+        if((_uiCmdLen == 0) && (*pucBuf != VC0706_PROTOCOL_SIGN_RECEIVE))
+        {
+            pucBuf++;
+            continue;
+        }
+        _ucCmdBuf[_uiCmdLen++] = *pucBuf++;
+
+        if(_uiCmdLen < _SIM_CMD_HEADER_SIZE)
+        {
+            continue;
+        }
+        uiNeed = _SIM_CMD_HEADER_SIZE + _ucCmdBuf[3];
+        if(_uiCmdLen == uiNeed)
+        {
+            _SimCommand();
+            _uiCmdLen = 0;
+        }
+    }
+}
+
+unsigned int VC0706UartRead(unsigned char *pucBuf, unsigned int uiLen,
+                            unsigned long ulTimeoutMs)
+{
+    unsigned long long ullTimeoutNs = ulTimeoutMs * _SIM_NS_PER_MS;
+    unsigned long long ullArrivalNs;
+    unsigned int uiRead = 0;
+    tSimSegment *psSeg;
+    unsigned char ucByte;
+
+    while(uiRead < uiLen)
+    {
+        if(_uiSegCount == 0)
+        {
+            _ullNowNs += ullTimeoutNs;
+            _sStats.ulTimeouts++;
+            break;
+        }
+
+        // A byte has fully arrived after its stop bit
+        psSeg = &_sSegments[_uiSegHead];
+        ullArrivalNs = psSeg->ullStartNs +
+                       (psSeg->uiPos + 1) * _SimByteNs(psSeg->ulBaudRate);
+        if(ullArrivalNs > _ullNowNs + ullTimeoutNs)
+        {
+            _ullNowNs += ullTimeoutNs;
+            _sStats.ulTimeouts++;
+            break;
+        }
+        if(ullArrivalNs > _ullNowNs)
+        {
+            _ullNowNs = ullArrivalNs;
+        }
+
+        ucByte = psSeg->pucData ? psSeg->pucData[psSeg->uiPos] :
+                                  psSeg->ucInline[psSeg->uiPos];
+        if(psSeg->ulBaudRate != _ulHostBaud)
+        {
+            ucByte = ~ucByte;
+            _sStats.ulBaudMismatches++;
+        }
+        pucBuf[uiRead++] = ucByte;
+        _sStats.ulBytesFromCamera++;
+
+        if(++psSeg->uiPos == psSeg->uiLen)
+        {
+            _uiSegHead = (_uiSegHead + 1) % _SIM_MAX_SEGMENTS;
+            _uiSegCount--;
+        }
+    }
+
+    return uiRead;
+}
+
+void VC0706UartFlush(void)
+{
+    unsigned long long ullIdleNs = VC0706_UART_FLUSH_IDLE_BYTES *
+                                   _SimByteNs(_ulHostBaud);
+    unsigned long long ullEndNs = _ullNowNs +
+                                  VC0706_UART_FLUSH_MAX_MS * _SIM_NS_PER_MS;
+    unsigned long long ullArrivalNs;
+    tSimSegment *psSeg;
+
+    // Like the driver, drop bytes until the line has been quiet for a few
+    // byte times
+    while(1)
+    {
+        _SimDropArrived();
+        if(_uiSegCount == 0)
+        {
+            break;
+        }
+
+        psSeg = &_sSegments[_uiSegHead];
+        ullArrivalNs = psSeg->ullStartNs +
+                       (psSeg->uiPos + 1) * _SimByteNs(psSeg->ulBaudRate);
+        if((ullArrivalNs > _ullNowNs + ullIdleNs) || (ullArrivalNs > ullEndNs))
+        {
+            break;
+        }
+        _ullNowNs = ullArrivalNs;
+    }
+
+    _ullNowNs += ullIdleNs;
+    _SimDropArrived();
+}
+
+static void _SimDropArrived(void)
+{
+    tSimSegment *psSeg;
+
+    // Drop what has arrived, bytes still on the line come in later
+    while(_uiSegCount > 0)
+    {
+        psSeg = &_sSegments[_uiSegHead];
+        while((psSeg->uiPos < psSeg->uiLen) &&
+              (psSeg->ullStartNs + (psSeg->uiPos + 1) *
+               _SimByteNs(psSeg->ulBaudRate) <= _ullNowNs))
+        {
+            psSeg->uiPos++;
+        }
+        if(psSeg->uiPos < psSeg->uiLen)
+        {
+            break;
+        }
+        _uiSegHead = (_uiSegHead + 1) % _SIM_MAX_SEGMENTS;
+        _uiSegCount--;
+    }
+}
+
+//*****************************************************************************
+// Camera
+//*****************************************************************************
+static unsigned long _SimCameraBaud(void)
+{
+    if((_ulNextCameraBaud != _ulCameraBaud) && (_ullNowNs >= _ullBaudSwitchNs))
+    {
+        _ulCameraBaud = _ulNextCameraBaud;
+    }
+
+    return _ulCameraBaud;
+}
+
+static unsigned long long _SimByteNs(unsigned long ulBaudRate)
+{
+    return (_SIM_BITS_PER_BYTE * 1000000000ULL) / ulBaudRate;
+}
+
+static int _SimSizeIndex(unsigned char ucImageSize)
+{
+    switch(ucImageSize)
+    {
+    case VC0706_IMAGE_SIZE_640_480:
+        return 0;
+    case VC0706_IMAGE_SIZE_320_240:
+        return 1;
+    case VC0706_IMAGE_SIZE_160_120:
+        return 2;
+    default:
+        return -1;
+    }
+}
+
+static void _SimNewFrame(tSimFrameBuffer *psBuf)
+{
+    int iSize = _SimSizeIndex(_ucImageSize) + (_ucDownsize & 0x03);
+    const tSimImage *psImage;
+    unsigned long long ullLen;
+    unsigned int uiBody;
+    unsigned int i;
+
+    // Downsizing past the smallest size leaves it at the smallest
+    if(iSize >= _SIM_NUM_SIZES)
+    {
+        iSize = _SIM_NUM_SIZES - 1;
+    }
+
+    psBuf->uiLen = 0;
+    if(_uiNumImages[iSize] == 0)
+    {
+        return;
+    }
+    psImage = &_sImages[iSize][_uiFrameCount % _uiNumImages[iSize]];
+    _uiFrameCount++;
+
+    // Higher ratios make smaller frames
+    ullLen = (unsigned long long)psImage->uiLen * VC0706_COMPRESSION_DEFAULT /
+             (_ucCompression ? _ucCompression : 1);
+    if(ullLen < _SIM_MIN_FRAME_SIZE)
+    {
+        ullLen = _SIM_MIN_FRAME_SIZE;
+    }
+    if(ullLen > VC0706_SIM_MAX_FRAME_SIZE)
+    {
+        ullLen = VC0706_SIM_MAX_FRAME_SIZE;
+    }
+    psBuf->uiLen = (unsigned int)ullLen;
+
+    // The image's start, its body cut short or repeated, then its end, so
+    // at the default ratio the frame is the image
+    uiBody = psImage->uiLen - _SIM_MIN_FRAME_SIZE;
+    for(i=0; i<psBuf->uiLen - 2; i++)
+    {
+        psBuf->ucData[i] = (i < psImage->uiLen - 2) ? psImage->pucData[i] :
+                           psImage->pucData[2 + (uiBody ? (i - 2) % uiBody :
+                                                 0)];
+    }
+    psBuf->ucData[i] = psImage->pucData[psImage->uiLen - 2];
+    psBuf->ucData[i + 1] = psImage->pucData[psImage->uiLen - 1];
+}
+
+static unsigned long long _SimNextSensorFrame(unsigned long long ullNs)
+{
+    unsigned long long ullPeriodNs = _sConfig.ulFramePeriodUs * 1000ULL;
+    unsigned long long ullFrames;
+
+    if(ullPeriodNs == 0)
+    {
+        return ullNs;
+    }
+
+    ullFrames = (ullNs - _ullSensorStartNs + ullPeriodNs - 1) / ullPeriodNs;
+
+    return _ullSensorStartNs + ullFrames * ullPeriodNs;
+}
+
+static unsigned long long _SimSend(const unsigned char *pucData,
+                                   unsigned int uiLen,
+                                   unsigned long long ullEarliestNs)
+{
+    tSimSegment *psSeg;
+    unsigned long ulBaudRate = _SimCameraBaud();
+
+    if((uiLen == 0) || (_uiSegCount == _SIM_MAX_SEGMENTS))
+    {
+        return _ullTxFreeNs;
+    }
+
+    psSeg = &_sSegments[(_uiSegHead + _uiSegCount) % _SIM_MAX_SEGMENTS];
+    _uiSegCount++;
+
+    // Small replies are copied, frame data is sent from the image
+    if(uiLen <= _SIM_INLINE_SIZE)
+    {
+        memcpy(psSeg->ucInline, pucData, uiLen);
+        psSeg->pucData = 0;
+    }
+    else
+    {
+        psSeg->pucData = pucData;
+    }
+    psSeg->uiLen = uiLen;
+    psSeg->uiPos = 0;
+    psSeg->ulBaudRate = ulBaudRate;
+    psSeg->ullStartNs = ullEarliestNs > _ullTxFreeNs ? ullEarliestNs :
+                                                       _ullTxFreeNs;
+
+    _ullTxFreeNs = psSeg->ullStartNs + uiLen * _SimByteNs(ulBaudRate);
+
+    return _ullTxFreeNs;
+}
+
+static unsigned long long _SimReply(unsigned char ucCmd,
+                                    unsigned char ucStatus,
+                                    const unsigned char *pucData,
+                                    unsigned char ucDataLen,
+                                    unsigned long long ullEarliestNs)
+{
+    unsigned char ucReply[_SIM_INLINE_SIZE];
+
+    if(ucStatus != VC0706_STATUS_SUCCESS)
+    {
+        _sStats.ulErrors++;
+    }
+
+    ucReply[0] = VC0706_PROTOCOL_SIGN_RETURN;
+    ucReply[1] = _ucCmdBuf[1];
+    ucReply[2] = ucCmd;
+    ucReply[3] = ucStatus;
+    ucReply[4] = ucDataLen;
+    memcpy(ucReply + 5, pucData, ucDataLen);
+
+    return _SimSend(ucReply, 5 + ucDataLen, ullEarliestNs);
+}
+
+static void _SimCommand(void)
+{
+    unsigned char ucCmd = _ucCmdBuf[2];
+    unsigned char *pucArgs = _ucCmdBuf + _SIM_CMD_HEADER_SIZE;
+    unsigned long long ullReadyNs;
+    unsigned short usValue;
+    unsigned int i;
+
+    _sStats.ulCommands++;
+    ullReadyNs = _ullNowNs + _sConfig.ulCommandDelayUs * 1000ULL;
+
+    switch(ucCmd)
+    {
+    case VC0706_COMMAND_GEN_VERSION:
+        _SimReply(ucCmd, VC0706_STATUS_SUCCESS,
+                  (const unsigned char *)_SIM_VERSION,
+                  sizeof(_SIM_VERSION) - 1, ullReadyNs);
+        break;
+
+    case VC0706_COMMAND_SET_PORT:
+        usValue = (pucArgs[1] << 8) | pucArgs[2];
+        for(i=0; i<_NUM_BAUD_RATES; i++)
+        {
+            if(_sBaudRates[i].usCameraBaud == usValue)
+            {
+                break;
+            }
+        }
+        if((pucArgs[0] != VC0706_INTERFACE_UART) || (i == _NUM_BAUD_RATES))
+        {
+            _SimReply(ucCmd, VC0706_STATUS_ERROR_DATA_FORMAT, 0, 0,
+                      ullReadyNs);
+            break;
+        }
+
+        // Acknowledged at the old rate, then the camera switches
+        _ullBaudSwitchNs = _SimReply(ucCmd, VC0706_STATUS_SUCCESS, 0, 0,
+                                     ullReadyNs);
+        _ulNextCameraBaud = _sBaudRates[i].ulBaudRate;
+        break;
+
+    case VC0706_COMMAND_WRITE_DATA:
+        // Type, byte count, register address, value. Both take effect with
+        // the next frame.
+        usValue = (pucArgs[2] << 8) | pucArgs[3];
+        if(usValue == _SIM_REG_IMAGE_SIZE)
+        {
+            _ucImageSize = pucArgs[4];
+        }
+        else if(usValue == _SIM_REG_COMPRESSION)
+        {
+            _ucCompression = pucArgs[4];
+        }
+        _SimReply(ucCmd, VC0706_STATUS_SUCCESS, 0, 0, ullReadyNs);
+        break;
+
+    case VC0706_COMMAND_FBUF_CTRL:
+        _SimFrameControl(pucArgs[0], ullReadyNs);
+        break;
+
+    case VC0706_COMMAND_GET_FBUF_LEN:
+        _SimFrameLength(ullReadyNs);
+        break;
+
+    case VC0706_COMMAND_READ_FBUF:
+        _SimReadFrameBuffer(ullReadyNs);
+        break;
+
+    case VC0706_COMMAND_DOWNSIZE_CTRL:
+        _ucDownsize = pucArgs[0];
+        _SimReply(ucCmd, VC0706_STATUS_SUCCESS, 0, 0, ullReadyNs);
+        break;
+
+    case VC0706_COMMAND_SET_SERIAL_NUM:
+    case VC0706_COMMAND_SYSTEM_RESET:
+    case VC0706_COMMAND_COMM_MOTION_CTRL:
+    case VC0706_COMMAND_MOTION_CTRL:
+        // Accepted; the simulated camera never sees motion
+        _SimReply(ucCmd, VC0706_STATUS_SUCCESS, 0, 0, ullReadyNs);
+        break;
+
+    default:
+        _SimReply(ucCmd, VC0706_STATUS_ERROR_COMMAND, 0, 0, ullReadyNs);
+        break;
+    }
+}
+
+static void _SimFrameControl(unsigned char ucCtrl,
+                             unsigned long long ullReadyNs)
+{
+    tSimFrameBuffer *psCurrent = &_sFrameBufs[VC0706_CURRENT_FRAME];
+    tSimFrameBuffer *psNext = &_sFrameBufs[VC0706_NEXT_FRAME];
+
+    switch(ucCtrl)
+    {
+    case VC0706_CURRENT_FRAME_CONTROL_STOP:
+        // Freezes the frame the sensor is filling in once it is done
+        if(!psCurrent->bFrozen)
+        {
+            psCurrent->bFrozen = 1;
+            _SimNewFrame(psCurrent);
+        }
+        if(psCurrent->ullReadyNs > ullReadyNs)
+        {
+            ullReadyNs = psCurrent->ullReadyNs;
+        }
+        break;
+    case VC0706_NEXT_FRAME_CONTROL_STOP:
+        // The sensor keeps running, the next frame it completes is kept
+        if(!psNext->bFrozen)
+        {
+            psNext->bFrozen = 1;
+            psNext->ullReadyNs = _SimNextSensorFrame(ullReadyNs);
+            _SimNewFrame(psNext);
+        }
+        if(psNext->ullReadyNs > ullReadyNs)
+        {
+            ullReadyNs = psNext->ullReadyNs;
+        }
+        break;
+    case VC0706_CURRENT_FRAME_CONTROL_RESUME:
+        // The current frame has to fill again before the next freeze
+        psCurrent->bFrozen = 0;
+        psNext->bFrozen = 0;
+        psCurrent->ullReadyNs = ullReadyNs +
+                                _sConfig.ulFramePeriodUs * 1000ULL;
+        break;
+    case VC0706_CURRENT_FRAME_CONTROL_STEP:
+        // Acknowledged at once, the stepped frame is held when it is done
+        psCurrent->bFrozen = 1;
+        psCurrent->ullReadyNs = ullReadyNs +
+                                _sConfig.ulFramePeriodUs * 1000ULL;
+        _SimNewFrame(psCurrent);
+        break;
+    default:
+        _SimReply(VC0706_COMMAND_FBUF_CTRL, VC0706_STATUS_ERROR_DATA_FORMAT,
+                  0, 0, ullReadyNs);
+        return;
+    }
+
+    _SimReply(VC0706_COMMAND_FBUF_CTRL, VC0706_STATUS_SUCCESS, 0, 0,
+              ullReadyNs);
+}
+
+static void _SimFrameLength(unsigned long long ullReadyNs)
+{
+    unsigned char ucType = _ucCmdBuf[_SIM_CMD_HEADER_SIZE];
+    tSimFrameBuffer *psBuf;
+    unsigned char ucData[4];
+
+    if(ucType > VC0706_NEXT_FRAME)
+    {
+        _SimReply(VC0706_COMMAND_GET_FBUF_LEN, VC0706_STATUS_ERROR_DATA_FORMAT,
+                  0, 0, ullReadyNs);
+        return;
+    }
+
+    // Only a frozen frame has a length, known once it is complete
+    psBuf = &_sFrameBufs[ucType];
+    if(!psBuf->bFrozen)
+    {
+        _SimReply(VC0706_COMMAND_GET_FBUF_LEN, VC0706_STATUS_ERROR_CANT_EXECUTE,
+                  0, 0, ullReadyNs);
+        return;
+    }
+    if(psBuf->ullReadyNs > ullReadyNs)
+    {
+        ullReadyNs = psBuf->ullReadyNs;
+    }
+
+    ucData[0] = (psBuf->uiLen >> 24) & 0xFF;
+    ucData[1] = (psBuf->uiLen >> 16) & 0xFF;
+    ucData[2] = (psBuf->uiLen >> 8) & 0xFF;
+    ucData[3] = psBuf->uiLen & 0xFF;
+    _SimReply(VC0706_COMMAND_GET_FBUF_LEN, VC0706_STATUS_SUCCESS, ucData,
+              sizeof(ucData), ullReadyNs);
+}
+
+static void _SimReadFrameBuffer(unsigned long long ullReadyNs)
+{
+    unsigned char *pucArgs = _ucCmdBuf + _SIM_CMD_HEADER_SIZE;
+    tSimFrameBuffer *psBuf;
+    unsigned int uiOffset;
+    unsigned int uiLen;
+    unsigned int uiDelay;
+    unsigned long long ullDataNs;
+
+    // Frame type, control mode, offset(4), length(4), delay(2)
+    uiOffset = ((unsigned int)pucArgs[2] << 24) | (pucArgs[3] << 16) |
+               (pucArgs[4] << 8) | pucArgs[5];
+    uiLen = ((unsigned int)pucArgs[6] << 24) | (pucArgs[7] << 16) |
+            (pucArgs[8] << 8) | pucArgs[9];
+    uiDelay = (pucArgs[10] << 8) | pucArgs[11];
+
+    if((pucArgs[0] > VC0706_NEXT_FRAME) ||
+       ((pucArgs[1] != VC0706_CONTROL_MODE_MCU) &&
+        (pucArgs[1] != VC0706_CONTROL_MODE_DMA)))
+    {
+        _SimReply(VC0706_COMMAND_READ_FBUF, VC0706_STATUS_ERROR_DATA_FORMAT,
+                  0, 0, ullReadyNs);
+        return;
+    }
+
+    psBuf = &_sFrameBufs[pucArgs[0]];
+    if(!psBuf->bFrozen)
+    {
+        _SimReply(VC0706_COMMAND_READ_FBUF, VC0706_STATUS_ERROR_CANT_EXECUTE,
+                  0, 0, ullReadyNs);
+        return;
+    }
+    if((psBuf->uiLen == 0) || (uiOffset + uiLen > psBuf->uiLen))
+    {
+        _SimReply(VC0706_COMMAND_READ_FBUF, VC0706_STATUS_ERROR_DATA_LENGTH,
+                  0, 0, ullReadyNs);
+        return;
+    }
+    if(psBuf->ullReadyNs > ullReadyNs)
+    {
+        ullReadyNs = psBuf->ullReadyNs;
+    }
+
+    // Header, data after the requested delay, then the header again. In DMA
+    // mode the camera's processor does not copy the data, so no delay.
+    ullDataNs = _SimReply(VC0706_COMMAND_READ_FBUF, VC0706_STATUS_SUCCESS,
+                          0, 0, ullReadyNs);
+    if(pucArgs[1] == VC0706_CONTROL_MODE_MCU)
+    {
+        ullDataNs += uiDelay * _SIM_FBUF_DELAY_NS;
+    }
+    _SimSend(psBuf->ucData + uiOffset, uiLen, ullDataNs);
+    _SimReply(VC0706_COMMAND_READ_FBUF, VC0706_STATUS_SUCCESS, 0, 0,
+              _ullTxFreeNs);
+}
@@ -0,0 +1,84 @@
+//*****************************************************************************
+//
+// vc0706_sim.h
+//
+// Simulated VC0706 Serial Camera Module for running the camera driver on a
+// host. Implements the UART interface of vc0706_uart.h, the clock of
+// clock_if.h and osi_Sleep() against a model of the camera that serves
+// JPEG files, so vc0706.c and vc0706_if.c build unchanged.
+//
+// Time is simulated: every byte on the link takes ten bit times at the
+// current baud rate, and the camera answers each command after a fixed
+// processing delay. Runs are repeatable and much faster than real time.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef _VC0706_SIM_H_
+#define _VC0706_SIM_H_
+
+
+//*****************************************************************************
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+//*****************************************************************************
+// Defines
+//*****************************************************************************
+#define VC0706_SIM_MAX_IMAGES               8       // Per image size
+#define VC0706_SIM_MAX_FRAME_SIZE           (128 * 1024)    // Frame buffer
+#define VC0706_SIM_DEFAULT_COMMAND_DELAY_US 500     // Command to response
+#define VC0706_SIM_DEFAULT_FRAME_PERIOD_US  33333   // 30 frames per second
+
+
+//*****************************************************************************
+// Types
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulCommandDelayUs;     // Processing time of each command
+    unsigned long ulFramePeriodUs;      // Sensor time to capture a new frame
+} tVC0706SimConfig;
+
+typedef struct
+{
+    unsigned long ulCommands;           // Commands the camera understood
+    unsigned long ulErrors;             // ...and answered with an error
+    unsigned long ulBytesToCamera;
+    unsigned long ulBytesFromCamera;
+    unsigned long ulBaudMismatches;     // Bytes lost to a wrong baud rate
+    unsigned long ulTimeouts;           // Reads that ran out of data
+} tVC0706SimStats;
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+extern void VC0706SimPowerOn(const tVC0706SimConfig *psConfig);
+extern tBoolean VC0706SimAddImage(unsigned char ucImageSize,
+                                  const unsigned char *pucJpeg,
+                                  unsigned int uiLen);
+extern unsigned long VC0706SimGetBaudRate(void);
+extern void VC0706SimGetStats(tVC0706SimStats *psStats);
+extern unsigned long long VC0706SimGetTimeUs(void);
+
+
+//*****************************************************************************
+// Mark the end of the C bindings section for C++ compilers.
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _VC0706_SIM_H_ */
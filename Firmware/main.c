@@ -13,7 +13,7 @@
 // December 4, 2015
 //
 // Modified:
-// December 19, 2015
+// October 17, 2026
 //
 //*****************************************************************************
 
@@ -22,7 +22,7 @@
 // Includes
 //*****************************************************************************
 // Standard includes
-#include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 
 // Hardware includes
@@ -56,24 +56,95 @@
 #include "common.h"
 
 // TFTP includes
-#include "datatypes.h"
-#include "tftp.h"
+#include "frame_info.h"
+#include "tftp_stream.h"
+#include "frame_stream.h"
 
 // Application includes
 #include "pin_mux_config.h"
 #include "vc0706.h"
 #include "vc0706_if.h"
+#include "frame_queue.h"
+#include "frame_pool.h"
+#include "clock_if.h"
+#include "rate_ctrl.h"
 
 
 //*****************************************************************************
 // Defines
 //*****************************************************************************
 #define TFTP_IP         0xC0A8010E      // This is the host IP: 192.168.1.14
+#define CAMERA_NAME     "writeToServer" // Set per device, the server keys
+                                        // frames by it
+#define TFTP_FILE_NAME  CAMERA_NAME ".jpg"
 #define FILE_SIZE_MAX   (20*1024)       // Max File Size set to 20KB
 #define SSID            "NETGEAR31"
 #define SSID_KEY        "happystar329"
 #define OSI_STACK_SIZE  2048
 
+// Capture pipelines
+#define PIPELINE_BUFFERED       0       // Capture a frame, then send it
+#define PIPELINE_STREAM         1       // Send chunks while reading the frame
+#define PIPELINE_QUEUED         2       // Capture and network tasks + queue
+
+// Frame transports
+#define TRANSPORT_TFTP          0       // One TFTP upload per frame
+#define TRANSPORT_STREAM        1       // Frames on a long-lived TCP stream
+
+#define CAPTURE_PIPELINE        PIPELINE_QUEUED
+#define FRAME_TRANSPORT         TRANSPORT_TFTP
+#define CAPTURE_BENCHMARK       0       // Upload read mode benchmark on boot
+#define CAPTURE_MOTION_GATED    0       // Only capture after camera motion
+#define CAPTURE_PULL            0       // Only capture when the server asks
+#define RATE_CONTROL            1       // Trade quality for frame rate
+
+#if CAPTURE_PULL
+// One frame per TFTP read request, taken when the request comes in
+#if (CAPTURE_PIPELINE == PIPELINE_QUEUED) || \
+    (FRAME_TRANSPORT != TRANSPORT_TFTP) || CAPTURE_BENCHMARK || \
+    CAPTURE_MOTION_GATED
+#error "Pull mode needs the buffered or stream pipeline over TFTP"
+#endif
+#endif
+
+#if CAPTURE_PULL || CAPTURE_MOTION_GATED
+// A frame stepped in after the last request or burst may be minutes old
+#define CAPTURE_MODE            CAMERA_CAPTURE_STOP_RESUME
+#else
+#define CAPTURE_MODE            CAMERA_CAPTURE_STEP
+#endif
+
+#if RATE_CONTROL
+// About 12 KB at the default ratio, so the best level's ratio leaves
+// FILE_SIZE_MAX some room. Busier scenes that still do not fit step down.
+#define CAPTURE_IMAGE_SIZE      VC0706_IMAGE_SIZE_320_240
+#define RATE_TARGET_MS          200     // 5 frames per second
+#define RATE_START_LEVEL        1
+#else
+#define CAPTURE_IMAGE_SIZE      CAMERA_DEFAULT_IMAGE_SIZE
+#endif
+
+#define FRAME_QUEUE_DEPTH       2
+#if CAPTURE_PIPELINE == PIPELINE_QUEUED
+// One frame being captured, one being sent and a full queue in between
+#define FRAME_POOL_SIZE         (FRAME_QUEUE_DEPTH + 2)
+#else
+#define FRAME_POOL_SIZE         1
+#endif
+#define NETWORK_STACK_SIZE      2048
+#define NETWORK_TASK_PRIORITY   1
+
+#define BENCHMARK_FILE_NAME     "benchmark.txt"
+#define BENCHMARK_FRAMES        5
+
+#define TFTP_BLOCK_SIZE         TFTP_STREAM_BLOCK_SIZE_MAX
+#define TFTP_WINDOW_SIZE        TFTP_STREAM_WINDOW_SIZE_MAX
+
+#define MOTION_BURST_FRAMES     5       // Frames to capture per motion event
+#define MOTION_HITS             2       // Motion alarms needed...
+#define MOTION_WINDOW_MS        1000    // ...within this time
+#define MOTION_WAIT_MS          10000
+
 
 //*****************************************************************************
 // Variables
@@ -81,13 +152,69 @@
 // Vector table defined exterenally (in startup_css.c)
 extern void (* const g_pfnVectors[])(void);
 
+// Frames are captured into these instead of the heap
+static unsigned char g_ucFramePool[FRAME_POOL_SIZE][FILE_SIZE_MAX];
+
+static unsigned int g_uiFrameSeq;
+static unsigned char g_ucFrameFlags;
+static unsigned long g_ulLastSentMs;        // Send of the previous frame done
+#if CAPTURE_PULL
+static tBoolean g_bRequestAnswered;         // OACK sent for the frame
+#endif
+
+#if RATE_CONTROL
+// Best first. Compression goes up before resolution goes down.
+static const tRateLevel g_sRateLevels[] =
+{
+    {VC0706_DOWNSIZE_1_1, 0x28},
+    {VC0706_DOWNSIZE_1_1, VC0706_COMPRESSION_DEFAULT},
+    {VC0706_DOWNSIZE_1_1, 0x60},
+    {VC0706_DOWNSIZE_1_2, VC0706_COMPRESSION_DEFAULT},
+    {VC0706_DOWNSIZE_1_2, 0x60},
+    {VC0706_DOWNSIZE_1_4, VC0706_COMPRESSION_DEFAULT},
+    {VC0706_DOWNSIZE_1_4, 0x90}
+};
+#endif
+
 
 //*****************************************************************************
 // Function Prototypes
 //*****************************************************************************
 static void BoardInit(void);
 static void NetInit(void);
-static void TFTPWrite(unsigned char *pucBuf, unsigned long ulBufSize);
+static void TFTPWrite(const char *pcFileName, unsigned char *pucBuf,
+                      unsigned long ulBufSize, const tFrameInfo *psInfo);
+#if CAPTURE_PULL
+static void TFTPServe(unsigned char *pucBuf, unsigned long ulBufSize,
+                      const tFrameInfo *psInfo);
+#endif
+static void FrameInfoFill(tFrameInfo *psInfo);
+#if FRAME_TRANSPORT == TRANSPORT_STREAM
+static tBoolean FrameStreamChunk(unsigned char *pucChunk,
+                                 unsigned int uiChunkLen,
+                                 unsigned int uiOffset,
+                                 unsigned int uiFrameLen,
+                                 void *pvArg);
+#else
+static tBoolean TFTPStreamChunk(unsigned char *pucChunk,
+                                unsigned int uiChunkLen,
+                                unsigned int uiOffset,
+                                unsigned int uiFrameLen,
+                                void *pvArg);
+#endif
+static void SendFrame(unsigned char *pucBuf, unsigned int uiLen,
+                      tFrameInfo *psInfo);
+#if CAPTURE_BENCHMARK
+static void CaptureBenchmark(void);
+#if CAPTURE_PIPELINE == PIPELINE_QUEUED
+static void NetworkWaitIdle(void);
+#endif
+#endif
+static void CaptureFrame(void);
+#if CAPTURE_PIPELINE == PIPELINE_QUEUED
+static void FrameRelease(tFrame *psFrame);
+static void NetworkTask(void *pvParameters);
+#endif
 static void MainTask(void);
 
 
@@ -108,13 +235,6 @@ void main()
     GPIO_IF_LedConfigure(LED1|LED2|LED3);
     GPIO_IF_LedOff(MCU_ALL_LED_IND);
 
-    // Camera Initialzation
-    if(!CameraInit(CAMERA_DEFAULT_SERIAL_NUM, CAMERA_DEFAULT_BAUD_RATE,
-            CAMERA_DEFAULT_IMAGE_SIZE))
-    {
-        LOOP_FOREVER();
-    }
-
     // Start the SimpleLink Host
     lRetVal = VStartSimpleLinkSpawnTask(SPAWN_TASK_PRIORITY);
     if(lRetVal < 0)
@@ -179,54 +299,520 @@ static void NetInit(void)
     lRetVal = Network_IF_ConnectAP(SSID, secParams);
 }
 
-static void TFTPWrite(unsigned char *pucBuf, unsigned long ulBufSize)
+static void TFTPWrite(const char *pcFileName, unsigned char *pucBuf,
+                      unsigned long ulBufSize, const tFrameInfo *psInfo)
 {
-    unsigned long ulFileSize;
+    // Send to server, with larger blocks and windows if it supports them
+    if(!TFTPStreamOpen(TFTP_IP, pcFileName, ulBufSize, psInfo) ||
+       !TFTPStreamWrite(pucBuf, ulBufSize) ||
+       !TFTPStreamClose())
+    {
+        TFTPStreamAbort();
+        LOOP_FOREVER();
+    }
 
-    char *FileWrite = "writeToServer.jpg";  // File to be written using TFTP
+    //UART_PRINT("Snapshot sent.\r\n");
+}
 
-    long lRetVal = -1;
-    unsigned short uiTftpErrCode;
+#if CAPTURE_PULL
+static void TFTPServe(unsigned char *pucBuf, unsigned long ulBufSize,
+                      const tFrameInfo *psInfo)
+{
+    // Answer the read request, a server that went away only loses this
+    // frame and asks again
+    if(!TFTPStreamRespond(ulBufSize, psInfo) ||
+       !TFTPStreamWrite(pucBuf, ulBufSize) ||
+       !TFTPStreamClose())
+    {
+        TFTPStreamAbort();
+    }
+}
+#endif
+
+#if FRAME_TRANSPORT == TRANSPORT_STREAM
+static tBoolean FrameStreamChunk(unsigned char *pucChunk,
+                                 unsigned int uiChunkLen,
+                                 unsigned int uiOffset,
+                                 unsigned int uiFrameLen,
+                                 void *pvArg)
+{
+    tFrameInfo sInfo;
 
-    // Send to server
-    lRetVal = sl_TftpSend(TFTP_IP, FileWrite, (char *)pucBuf,\
-                        &ulBufSize, &uiTftpErrCode);
-    if(lRetVal < 0)
+    // The header goes out once the camera has a frame ready, before the
+    // frame is read
+    if(uiOffset == 0)
     {
-        ERR_PRINT(lRetVal);
+        FrameInfoFill(&sInfo);
+        sInfo.ulPrevSent = g_ulLastSentMs;
+        if(!FrameStreamBegin(uiFrameLen, &sInfo))
+        {
+            return 0;
+        }
+    }
+
+    return FrameStreamWrite(pucChunk, uiChunkLen);
+}
+#else
+static tBoolean TFTPStreamChunk(unsigned char *pucChunk,
+                                unsigned int uiChunkLen,
+                                unsigned int uiOffset,
+                                unsigned int uiFrameLen,
+                                void *pvArg)
+{
+    tFrameInfo sInfo;
+
+    // Start the transfer once the camera has a frame ready, before the
+    // frame is read
+    if(uiOffset == 0)
+    {
+        FrameInfoFill(&sInfo);
+        sInfo.ulPrevSent = g_ulLastSentMs;
+#if CAPTURE_PULL
+        if(!TFTPStreamRespond(uiFrameLen, &sInfo))
+#else
+        if(!TFTPStreamOpen(TFTP_IP, TFTP_FILE_NAME, uiFrameLen, &sInfo))
+#endif
+        {
+            return 0;
+        }
+#if CAPTURE_PULL
+        g_bRequestAnswered = 1;
+#endif
+    }
+
+    return TFTPStreamWrite(pucChunk, uiChunkLen);
+}
+#endif
+
+static void FrameInfoFill(tFrameInfo *psInfo)
+{
+    tCameraFrameTimes sTimes;
+
+    CameraGetFrameTimes(&sTimes);
+
+    psInfo->uiSeq = g_uiFrameSeq;
+    psInfo->ulCaptureStart = sTimes.ulCaptureStart;
+    psInfo->ulLengthRead = sTimes.ulLengthRead;
+    psInfo->ulReadDone = sTimes.ulReadDone;
+    psInfo->ulPrevSent = 0;
+    psInfo->ucFlags = g_ucFrameFlags;
+}
+
+static void SendFrame(unsigned char *pucBuf, unsigned int uiLen,
+                      tFrameInfo *psInfo)
+{
+#if RATE_CONTROL
+#if CAPTURE_PIPELINE == PIPELINE_QUEUED
+    unsigned long ulSendStart = ClockGetMs();
+#endif
+    unsigned long ulFrameMs;
+#endif
+
+    // Frames go out in order, so this is the frame before this one
+    psInfo->ulPrevSent = g_ulLastSentMs;
+
+#if FRAME_TRANSPORT == TRANSPORT_STREAM
+    // A frame is lost with the connection, which is made again for the next
+    FrameStreamSend(pucBuf, uiLen, psInfo);
+#elif CAPTURE_PULL
+    TFTPServe(pucBuf, uiLen, psInfo);
+#else
+    TFTPWrite(TFTP_FILE_NAME, pucBuf, uiLen, psInfo);
+#endif
+
+    g_ulLastSentMs = ClockGetMs();
+
+#if RATE_CONTROL
+#if CAPTURE_PIPELINE == PIPELINE_QUEUED
+    // The next frame is read while this one is sent, the slower of the two
+    // sets the frame rate
+    ulFrameMs = g_ulLastSentMs - ulSendStart;
+    if(psInfo->ulReadDone - psInfo->ulCaptureStart > ulFrameMs)
+    {
+        ulFrameMs = psInfo->ulReadDone - psInfo->ulCaptureStart;
+    }
+#else
+    ulFrameMs = g_ulLastSentMs - psInfo->ulCaptureStart;
+#endif
+    RateCtrlFrameDone(ulFrameMs);
+#endif
+}
+
+#if CAPTURE_BENCHMARK
+static void CaptureBenchmark(void)
+{
+    static const unsigned int uiChunkSizes[] = {64, 128, 255, 512, 1024,
+                                                4096, 0};
+    static const unsigned char ucCtrlModes[] = {VC0706_CONTROL_MODE_MCU,
+                                                VC0706_CONTROL_MODE_DMA};
+    static const unsigned char ucCaptureModes[] = {CAMERA_CAPTURE_STOP_RESUME,
+                                                   CAMERA_CAPTURE_STEP,
+                                                   CAMERA_CAPTURE_NEXT_FRAME};
+    static char cReport[1024];
+    tCameraStats sStats;
+#if CAPTURE_PIPELINE == PIPELINE_QUEUED
+    tFrameQueueStats sQueueStats;
+#endif
+    tCameraBenchResult sResults[sizeof(uiChunkSizes)/sizeof(uiChunkSizes[0])];
+    unsigned int uiNumSizes = sizeof(uiChunkSizes)/sizeof(uiChunkSizes[0]);
+    static const unsigned int uiTftpOptions[][2] = {
+        {TFTP_STREAM_BLOCK_SIZE, 1}, {TFTP_BLOCK_SIZE, 1},
+        {TFTP_BLOCK_SIZE, TFTP_WINDOW_SIZE}};
+    unsigned char *pucBuf;
+    unsigned int uiFrameLen;
+    unsigned int uiBlockSize, uiWindowSize;
+    unsigned long ulStart;
+    unsigned int uiLen = 0;
+    unsigned int uiBest;
+    unsigned int i, j;
+
+    pucBuf = FramePoolAcquire(OSI_WAIT_FOREVER);
+
+    // The camera shares UART0 with the console, so results go to the server
+    uiLen += sprintf(cReport+uiLen, "baud %lu\nmode chunk frames bytes ms\n",
+                     CameraGetBaudRate());
+    for(i=0; i<sizeof(ucCtrlModes); i++)
+    {
+        uiBest = CameraBenchmarkReadMode(uiChunkSizes, uiNumSizes,
+                                         ucCtrlModes[i], BENCHMARK_FRAMES,
+                                         pucBuf, FramePoolGetBufSize(),
+                                         sResults);
+        for(j=0; j<uiNumSizes; j++)
+        {
+            uiLen += sprintf(cReport+uiLen, "0x%02X %u %u %lu %lu%s\n",
+                             ucCtrlModes[i], sResults[j].uiChunkSize,
+                             sResults[j].uiFrames, sResults[j].ulBytes,
+                             sResults[j].ulElapsedMs,
+                             (j == uiBest) ? " best" : "");
+        }
+    }
+
+    // Upload time of one frame, plain TFTP against negotiated options
+    uiLen += sprintf(cReport+uiLen, "blksize windowsize bytes ms\n");
+    if(CameraSnapshot(pucBuf, FramePoolGetBufSize(), &uiFrameLen) ==
+       CAMERA_STATUS_OK)
+    {
+        for(i=0; i<sizeof(uiTftpOptions)/sizeof(uiTftpOptions[0]); i++)
+        {
+            TFTPStreamSetOptions(uiTftpOptions[i][0], uiTftpOptions[i][1]);
+
+            ulStart = ClockGetMs();
+            TFTPWrite(TFTP_FILE_NAME, pucBuf, uiFrameLen, NULL);
+            TFTPStreamGetOptions(&uiBlockSize, &uiWindowSize);
+            uiLen += sprintf(cReport+uiLen, "%u %u %u %lu\n", uiBlockSize,
+                             uiWindowSize, uiFrameLen,
+                             ClockGetMs() - ulStart);
+        }
+        TFTPStreamSetOptions(TFTP_BLOCK_SIZE, TFTP_WINDOW_SIZE);
+    }
+
+    FramePoolRelease(pucBuf);
+
+    // Frame rate of each capture mode, including the upload
+    uiLen += sprintf(cReport+uiLen, "capture frames bytes ms\n");
+    for(i=0; i<sizeof(ucCaptureModes); i++)
+    {
+        CameraSetCaptureMode(ucCaptureModes[i]);
+        for(j=0; j<BENCHMARK_FRAMES; j++)
+        {
+            CaptureFrame();
+        }
+#if CAPTURE_PIPELINE == PIPELINE_QUEUED
+        // Frames were only queued, count the time until they are sent
+        NetworkWaitIdle();
+#endif
+
+        CameraGetStats(&sStats);
+        uiLen += sprintf(cReport+uiLen, "%u %u %lu %lu %lu.%02lu fps\n",
+                         sStats.ucCaptureMode, sStats.uiFrames,
+                         sStats.ulBytes, sStats.ulElapsedMs,
+                         (sStats.uiFrames * 1000UL) /
+                         (sStats.ulElapsedMs ? sStats.ulElapsedMs : 1),
+                         ((sStats.uiFrames * 100000UL) /
+                         (sStats.ulElapsedMs ? sStats.ulElapsedMs : 1)) % 100);
+    }
+    CameraSetCaptureMode(CAPTURE_MODE);
+
+#if CAPTURE_PIPELINE == PIPELINE_QUEUED
+    // Dropped frames mean capture outran the uploads
+    FrameQueueGetStats(&sQueueStats);
+    uiLen += sprintf(cReport+uiLen, "queue depth max enqueued dequeued "
+                     "dropped\n%u %u %u %u %u\n", sQueueStats.uiDepth,
+                     sQueueStats.uiMaxQueued, sQueueStats.uiEnqueued,
+                     sQueueStats.uiDequeued, sQueueStats.uiDropped);
+#endif
+
+    TFTPWrite(BENCHMARK_FILE_NAME, (unsigned char *)cReport, uiLen, NULL);
+}
+
+#if CAPTURE_PIPELINE == PIPELINE_QUEUED
+static void NetworkWaitIdle(void)
+{
+    unsigned char *pucBufs[FRAME_POOL_SIZE];
+    unsigned int i;
+
+    // The network task frees a buffer only once its frame is sent, so with
+    // every buffer back it is idle and the TFTP client is free to use here
+    for(i=0; i<FRAME_POOL_SIZE; i++)
+    {
+        pucBufs[i] = FramePoolAcquire(OSI_WAIT_FOREVER);
+    }
+    for(i=0; i<FRAME_POOL_SIZE; i++)
+    {
+        FramePoolRelease(pucBufs[i]);
+    }
+}
+#endif
+#endif
+
+static void CaptureFrame(void)
+{
+#if CAPTURE_PIPELINE != PIPELINE_STREAM
+    unsigned char *pucBuf;
+    long lStatus;
+#endif
+#if CAPTURE_PIPELINE == PIPELINE_QUEUED
+    tFrame sFrame;
+#endif
+    unsigned int uiBufLen;
+#if CAPTURE_PIPELINE == PIPELINE_BUFFERED
+    tFrameInfo sInfo;
+#endif
+#if RATE_CONTROL
+    const tRateLevel *psLevel = RateCtrlGetLevel();
+#if CAPTURE_PIPELINE == PIPELINE_STREAM
+    tCameraFrameTimes sTimes;
+#endif
+
+    // A failed change is tried again with the next frame
+    CameraSetQuality(psLevel->ucDownsize, psLevel->ucCompression);
+#endif
+
+#if CAPTURE_PIPELINE == PIPELINE_STREAM
+    // Send snapshot to server while it is read from the camera
+#if FRAME_TRANSPORT == TRANSPORT_STREAM
+    CameraSnapshotStream(FrameStreamChunk, NULL, &uiBufLen);
+#else
+#if CAPTURE_PULL
+    g_bRequestAnswered = 0;
+#endif
+    if(!CameraSnapshotStream(TFTPStreamChunk, NULL, &uiBufLen) ||
+       !TFTPStreamClose())
+    {
+#if CAPTURE_PULL
+        // Only this frame is lost, the server asks again. Without an answer
+        // yet it would wait out its timeout first.
+        if(!g_bRequestAnswered)
+        {
+            TFTPStreamReject("Camera error");
+        }
+        TFTPStreamAbort();
+        return;
+#else
+        TFTPStreamAbort();
+        LOOP_FOREVER();
+#endif
+    }
+#endif
+    g_ulLastSentMs = ClockGetMs();
+    g_uiFrameSeq++;
+#if RATE_CONTROL
+    CameraGetFrameTimes(&sTimes);
+    RateCtrlFrameDone(g_ulLastSentMs - sTimes.ulCaptureStart);
+#endif
+#else
+    // Get snapshot from camera, waits for the network task to return a
+    // buffer if all of them are queued
+    pucBuf = FramePoolAcquire(OSI_WAIT_FOREVER);
+    lStatus = CameraSnapshot(pucBuf, FramePoolGetBufSize(), &uiBufLen);
+    if(lStatus == CAMERA_STATUS_ERROR)
+    {
+#if CAPTURE_PULL
+        // Only this frame is lost, the server asks again
+        TFTPStreamReject("Camera error");
+        FramePoolRelease(pucBuf);
+        return;
+#else
         LOOP_FOREVER();
+#endif
     }
 
-    //UART_PRINT("Snapshot sent.\r\n");
+    // Too big for a buffer, counted in the camera stats
+    if(lStatus == CAMERA_STATUS_SKIPPED)
+    {
+#if RATE_CONTROL
+        RateCtrlFrameOversized();
+#endif
+#if CAPTURE_PULL
+        TFTPStreamReject("Frame too large, try again");
+#endif
+        FramePoolRelease(pucBuf);
+        return;
+    }
+
+#if CAPTURE_PIPELINE == PIPELINE_QUEUED
+    // Hand snapshot to the network task
+    sFrame.pucBuf = pucBuf;
+    sFrame.uiLen = uiBufLen;
+    FrameInfoFill(&sFrame.sInfo);
+    g_uiFrameSeq++;
+    FrameQueuePut(&sFrame);
+#else
+    // Send snapshot to server
+    FrameInfoFill(&sInfo);
+    g_uiFrameSeq++;
+    SendFrame(pucBuf, uiBufLen, &sInfo);
+
+    FramePoolRelease(pucBuf);
+#endif
+#endif
 }
 
+#if CAPTURE_PIPELINE == PIPELINE_QUEUED
+static void FrameRelease(tFrame *psFrame)
+{
+    FramePoolRelease(psFrame->pucBuf);
+}
+
+static void NetworkTask(void *pvParameters)
+{
+    tFrame sFrame;
+
+    while (1)
+    {
+        if(!FrameQueueGet(&sFrame, OSI_WAIT_FOREVER))
+        {
+            continue;
+        }
+
+        // Send snapshot to server while the next one is captured
+        SendFrame(sFrame.pucBuf, sFrame.uiLen, &sFrame.sInfo);
+
+        FrameRelease(&sFrame);
+    }
+}
+#endif
+
 static void MainTask(void)
 {
-    unsigned char *pucBuf = NULL;
-    unsigned int uiBufLen;
+#if CAPTURE_MOTION_GATED
+    unsigned int uiBurstLeft;
+#endif
+
+    // Camera Initialzation, the camera UART blocks on RTOS objects so this
+    // has to run once the scheduler is up
+    if(!CameraInit(CAMERA_DEFAULT_SERIAL_NUM, CAMERA_DEFAULT_BAUD_RATE,
+            CAPTURE_IMAGE_SIZE))
+    {
+        LOOP_FOREVER();
+    }
+
+#if RATE_CONTROL
+    if(!RateCtrlInit(g_sRateLevels,
+                     sizeof(g_sRateLevels)/sizeof(g_sRateLevels[0]),
+                     RATE_START_LEVEL, RATE_TARGET_MS))
+    {
+        LOOP_FOREVER();
+    }
+#endif
+
+    // Keep the sensor busy on the next frame while this one is sent
+    if(!CameraSetCaptureMode(CAPTURE_MODE))
+    {
+        LOOP_FOREVER();
+    }
+
+    if(!FramePoolInit(&g_ucFramePool[0][0], FRAME_POOL_SIZE, FILE_SIZE_MAX))
+    {
+        LOOP_FOREVER();
+    }
 
     // Network Driver Initialization
     NetInit();
 
+    // Asked for on every upload, the server may lower them
+    TFTPStreamSetOptions(TFTP_BLOCK_SIZE, TFTP_WINDOW_SIZE);
+
+#if CAPTURE_PULL
+    // The server reads frames from the TFTP port instead
+    if(!TFTPStreamListen(TFTP_STREAM_PORT))
+    {
+        LOOP_FOREVER();
+    }
+#endif
+
+#if FRAME_TRANSPORT == TRANSPORT_STREAM
+    // Connected when the first frame is sent
+    FrameStreamInit(TFTP_IP, FRAME_STREAM_PORT);
+#endif
+
+#if CAPTURE_PIPELINE == PIPELINE_QUEUED
+    // This task keeps capturing while the network task sends
+    if(!FrameQueueInit(FRAME_QUEUE_DEPTH, FrameRelease))
+    {
+        LOOP_FOREVER();
+    }
+
+    if(osi_TaskCreate(NetworkTask,
+                    (const signed char *)"NetworkTask",
+                    NETWORK_STACK_SIZE,
+                    NULL,
+                    NETWORK_TASK_PRIORITY,
+                    NULL ) < 0)
+    {
+        LOOP_FOREVER();
+    }
+#endif
+
+#if CAPTURE_BENCHMARK
+    // Measure frame buffer read modes at the current baud rate
+    CaptureBenchmark();
+#endif
+
     // Output IP to terminal
     /*UART_PRINT("Packet destination: %d.%d.%d.%d\n\r",\
                   SL_IPV4_BYTE(TFTP_IP, 3), SL_IPV4_BYTE(TFTP_IP, 2),
                   SL_IPV4_BYTE(TFTP_IP, 1), SL_IPV4_BYTE(TFTP_IP, 0));*/
 
+#if CAPTURE_MOTION_GATED
+    CameraSetMotionSensitivity(MOTION_HITS, MOTION_WINDOW_MS);
+#endif
+
     while (1)
     {
-        // Get snapshot from camera
-        pucBuf = CameraSnapshot(&uiBufLen);
-        if(pucBuf == NULL)
+#if CAPTURE_MOTION_GATED
+        // Idle until the camera reports motion. Motion detection is off
+        // during the burst so alarms do not mix with command responses.
+        if(!CameraEnableMotion(1))
         {
             LOOP_FOREVER();
         }
 
-        // Send snapshot to server
-        TFTPWrite(pucBuf, uiBufLen);
+        while(!CameraWaitMotion(MOTION_WAIT_MS))
+        {
+        }
+
+        // Should the camera miss it, the driver drops the alarms that keep
+        // coming, so the burst goes ahead either way
+        CameraEnableMotion(0);
 
-        // Freeing memory
-        free(pucBuf);
+        // The server is told these frames follow motion
+        g_ucFrameFlags |= FRAME_FLAG_MOTION;
+        for(uiBurstLeft=MOTION_BURST_FRAMES; uiBurstLeft>0; uiBurstLeft--)
+        {
+            CaptureFrame();
+        }
+        g_ucFrameFlags &= ~FRAME_FLAG_MOTION;
+#elif CAPTURE_PULL
+        // Idle until the server asks for a frame, so frames are only made
+        // while someone wants them
+        if(TFTPStreamAccept())
+        {
+            CaptureFrame();
+        }
+#else
+        CaptureFrame();
+#endif
     }
 
     LOOP_FOREVER();
@@ -0,0 +1,182 @@
+//*****************************************************************************
+//
+// rate_ctrl.c
+//
+// Frame rate controller, see rate_ctrl.h.
+//
+// The time per frame is averaged, and the controller steps one level down
+// the ladder (smaller frames) after a few frames over the target, and one
+// level up after more frames well under it. The gap between the two
+// thresholds, the longer wait before a step up, and ignoring the frames
+// already captured at the old level keep it from oscillating. A step up
+// that is undone straight away, by frames over the target or by a frame too
+// large for its buffer, doubles the wait before the next one.
+//
+// Measurements come from the task that sends frames, oversized frames from
+// the capture task, so the state is kept under a lock.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#include "hw_types.h"
+#include "osi.h"
+
+#include "rate_ctrl.h"
+
+
+//*****************************************************************************
+// Variables
+//*****************************************************************************
+static OsiLockObj_t _Lock;
+static const tRateLevel *_psLevels;
+static unsigned int _uiNumLevels;
+static volatile unsigned int _uiLevel;
+static unsigned long _ulTargetMs;
+static unsigned long _ulAvgMs;              // 0 until the first frame
+static unsigned int _uiOver;                // Frames over target in a row
+static unsigned int _uiUnder;               // Frames under target in a row
+static unsigned int _uiSettle;
+static unsigned int _uiUpFrames;
+static unsigned int _uiSinceUp;             // Frames since a step up
+static tBoolean _bUpPending;                // ...that may still be undone
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+static void _RateCtrlSetLevel(unsigned int uiLevel);
+static void _RateCtrlStepDown(void);
+
+
+//*****************************************************************************
+// Function Implementations
+//*****************************************************************************
+tBoolean RateCtrlInit(const tRateLevel *psLevels, unsigned int uiNumLevels,
+                      unsigned int uiStartLevel, unsigned long ulTargetMs)
+{
+    if((uiNumLevels == 0) || (uiStartLevel >= uiNumLevels))
+    {
+        return 0;
+    }
+
+    if(osi_LockObjCreate(&_Lock) != OSI_OK)
+    {
+        return 0;
+    }
+
+    _psLevels = psLevels;
+    _uiNumLevels = uiNumLevels;
+    _ulTargetMs = ulTargetMs;
+    _uiUpFrames = RATE_CTRL_UP_FRAMES;
+    _bUpPending = 0;
+    _RateCtrlSetLevel(uiStartLevel);
+
+    return 1;
+}
+
+void RateCtrlFrameDone(unsigned long ulFrameMs)
+{
+    osi_LockObjLock(&_Lock, OSI_WAIT_FOREVER);
+
+    // Frames captured before the last change say nothing about the new level
+    if(_uiSettle > 0)
+    {
+        _uiSettle--;
+        osi_LockObjUnlock(&_Lock);
+        return;
+    }
+
+    if(_ulAvgMs == 0)
+    {
+        _ulAvgMs = ulFrameMs;
+    }
+    else
+    {
+        _ulAvgMs = (long)_ulAvgMs +
+                   (((long)ulFrameMs - (long)_ulAvgMs) >> RATE_CTRL_AVG_SHIFT);
+    }
+
+    // A step up that held for a full wait is accepted
+    if(_bUpPending && (++_uiSinceUp >= _uiUpFrames))
+    {
+        _bUpPending = 0;
+        _uiUpFrames = RATE_CTRL_UP_FRAMES;
+    }
+
+    if(_ulAvgMs * 100 > _ulTargetMs * RATE_CTRL_DOWN_PCT)
+    {
+        _uiOver++;
+        _uiUnder = 0;
+    }
+    else if(_ulAvgMs * 100 < _ulTargetMs * RATE_CTRL_UP_PCT)
+    {
+        _uiUnder++;
+        _uiOver = 0;
+    }
+    else
+    {
+        _uiOver = 0;
+        _uiUnder = 0;
+    }
+
+    if(_uiOver >= RATE_CTRL_DOWN_FRAMES)
+    {
+        _RateCtrlStepDown();
+    }
+    else if((_uiUnder >= _uiUpFrames) && (_uiLevel > 0))
+    {
+        _bUpPending = 1;
+        _uiSinceUp = 0;
+        _RateCtrlSetLevel(_uiLevel - 1);
+    }
+
+    osi_LockObjUnlock(&_Lock);
+}
+
+void RateCtrlFrameOversized(void)
+{
+    // Never sent, so it cannot be measured; a smaller frame is needed now
+    osi_LockObjLock(&_Lock, OSI_WAIT_FOREVER);
+    _RateCtrlStepDown();
+    osi_LockObjUnlock(&_Lock);
+}
+
+const tRateLevel *RateCtrlGetLevel(void)
+{
+    return &_psLevels[_uiLevel];
+}
+
+static void _RateCtrlStepDown(void)
+{
+    if(_uiLevel + 1 >= _uiNumLevels)
+    {
+        return;
+    }
+
+    // The level just stepped up to did not hold, wait longer next time
+    if(_bUpPending)
+    {
+        _bUpPending = 0;
+        _uiUpFrames *= 2;
+        if(_uiUpFrames > RATE_CTRL_UP_FRAMES_MAX)
+        {
+            _uiUpFrames = RATE_CTRL_UP_FRAMES_MAX;
+        }
+    }
+
+    _RateCtrlSetLevel(_uiLevel + 1);
+}
+
+static void _RateCtrlSetLevel(unsigned int uiLevel)
+{
+    _uiLevel = uiLevel;
+    _ulAvgMs = 0;
+    _uiOver = 0;
+    _uiUnder = 0;
+    _uiSettle = RATE_CTRL_SETTLE_FRAMES;
+}
@@ -0,0 +1,73 @@
+//*****************************************************************************
+//
+// rate_ctrl.h
+//
+// Frame rate controller. Picks a camera quality level (downsizing and JPEG
+// compression) from the measured time per frame, so the frame rate holds
+// on a slow link and quality comes back when the link allows it.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef _RATE_CTRL_H_
+#define _RATE_CTRL_H_
+
+
+//*****************************************************************************
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+//*****************************************************************************
+// Defines
+//*****************************************************************************
+#define RATE_CTRL_AVG_SHIFT                 2       // Average over ~4 frames
+#define RATE_CTRL_DOWN_PCT                  110     // Over target by 10%...
+#define RATE_CTRL_DOWN_FRAMES               3       // ...this many frames
+#define RATE_CTRL_UP_PCT                    70      // Under target by 30%...
+#define RATE_CTRL_UP_FRAMES                 10      // ...this many frames
+#define RATE_CTRL_UP_FRAMES_MAX             80      // After failed steps up
+#define RATE_CTRL_SETTLE_FRAMES             4       // In flight at a change
+
+
+//*****************************************************************************
+// Types
+//*****************************************************************************
+// One step of the quality ladder, best first
+typedef struct
+{
+    unsigned char ucDownsize;       // VC0706_DOWNSIZE_*
+    unsigned char ucCompression;    // Higher is smaller and worse
+} tRateLevel;
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+extern tBoolean RateCtrlInit(const tRateLevel *psLevels,
+                             unsigned int uiNumLevels,
+                             unsigned int uiStartLevel,
+                             unsigned long ulTargetMs);
+extern void RateCtrlFrameDone(unsigned long ulFrameMs);
+extern void RateCtrlFrameOversized(void);
+extern const tRateLevel *RateCtrlGetLevel(void);
+
+
+//*****************************************************************************
+// Mark the end of the C bindings section for C++ compilers.
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RATE_CTRL_H_ */
@@ -0,0 +1,911 @@
+//*****************************************************************************
+//
+// tftp_stream.c
+//
+// Minimal TFTP write client (RFC 1350) over SimpleLink sockets that accepts
+// the file in arbitrary pieces. The next block is filled while earlier ones
+// are on the air waiting for their ACK.
+//
+// The write request asks for a larger block size (RFC 2348), announces the
+// transfer size (RFC 2349) and asks for a window of several blocks per ACK
+// (RFC 7440). A server that answers with a plain ACK gets classic lock-step
+// 512 byte blocks, and one that refuses the options gets the request again
+// without them. Frame metadata (sequence number, device timestamps, flags)
+// rides along as further options, which servers that don't know them
+// ignore (RFC 2347).
+//
+// In serve mode the roles turn around: a client sends a read request to the
+// listening socket and the file goes back to it the same way. The client's
+// options are answered once the file is ready, so the transfer size and
+// frame metadata it asked for can be filled in.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#include <string.h>
+#include "hw_types.h"
+#include "simplelink.h"
+#include "frame_info.h"
+#include "clock_if.h"
+
+#include "tftp_stream.h"
+
+
+//*****************************************************************************
+// Defines
+//*****************************************************************************
+#define _TFTP_OP_RRQ                        1
+#define _TFTP_OP_WRQ                        2
+#define _TFTP_OP_DATA                       3
+#define _TFTP_OP_ACK                        4
+#define _TFTP_OP_ERROR                      5
+#define _TFTP_OP_OACK                       6
+#define _TFTP_HEADER_SIZE                   4
+#define _TFTP_MODE                          "octet"
+#define _TFTP_OPTION_BLKSIZE                "blksize"
+#define _TFTP_OPTION_TSIZE                  "tsize"
+#define _TFTP_OPTION_WINDOWSIZE             "windowsize"
+#define _TFTP_OPTION_SEQ                    "seq"
+#define _TFTP_OPTION_CAPTURE_START          "tcap"
+#define _TFTP_OPTION_LENGTH_READ            "tlen"
+#define _TFTP_OPTION_READ_DONE              "tread"
+#define _TFTP_OPTION_PREV_SENT              "tsent"
+#define _TFTP_OPTION_FLAGS                  "flags"
+#define _TFTP_OPTIONS_MAX_LEN               160
+#define _TFTP_MIN_BLOCK_SIZE                8
+#define _TFTP_RQ_BUF_SIZE                   (100 + _TFTP_OPTIONS_MAX_LEN)
+#define _TFTP_RESP_BUF_SIZE                 _TFTP_RQ_BUF_SIZE   // Holds RRQs
+#define _TFTP_ERROR_NOT_DEFINED             0
+
+// Options a read request asked for, answered in the OACK
+#define _TFTP_REQ_BLKSIZE                   0x01
+#define _TFTP_REQ_TSIZE                     0x02
+#define _TFTP_REQ_WINDOWSIZE                0x04
+#define _TFTP_REQ_INFO                      0x08
+
+// One block is filled while a full window waits for its ACK
+#define _TFTP_NUM_BLOCKS                    (TFTP_STREAM_WINDOW_SIZE_MAX + 1)
+#define _TFTP_BLOCK_BUF(ulBlock)            _ucBlockBuf[(ulBlock) % \
+                                                        _TFTP_NUM_BLOCKS]
+
+
+//*****************************************************************************
+// Variables
+//*****************************************************************************
+static short _sSocket = -1;
+static short _sListenSocket = -1;
+static unsigned char _ucReqOptions;         // _TFTP_REQ_* of a read request
+static SlSockAddrIn_t _sServerAddr;
+static SlSockAddrIn_t _sLastClientAddr;     // Of the last request accepted
+static unsigned long _ulLastClientMs;       // ...and when it was served
+static tBoolean _bLatchPort;
+static unsigned char _ucBlockBuf[_TFTP_NUM_BLOCKS]
+                                [_TFTP_HEADER_SIZE+TFTP_STREAM_BLOCK_SIZE_MAX];
+static unsigned int _uiBlockLen[_TFTP_NUM_BLOCKS];
+static unsigned int _uiFillLen;
+static unsigned long _ulNextBlock;          // Block being filled
+static unsigned long _ulAckedBlock;         // Last block acknowledged
+static tBoolean _bDupAckResent;             // Went back on a repeated ACK
+static unsigned int _uiReqBlockSize = TFTP_STREAM_BLOCK_SIZE_MAX;
+static unsigned int _uiReqWindowSize = TFTP_STREAM_WINDOW_SIZE_MAX;
+static unsigned int _uiBlockSize;           // Negotiated with the server
+static unsigned int _uiWindowSize;
+static unsigned char _ucRespBuf[_TFTP_RESP_BUF_SIZE];
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+static tBoolean _TFTPStreamSocket(void);
+static tBoolean _TFTPStreamSend(const unsigned char *pucPacket,
+                                unsigned int uiLen);
+static short _TFTPStreamRecv(void);
+static tBoolean _TFTPStreamRequest(const char *pcFileName,
+                                   unsigned long ulTransferSize,
+                                   const tFrameInfo *psInfo,
+                                   tBoolean bOptions, tBoolean *pbRefused);
+static unsigned int _TFTPStreamPutOption(unsigned char *pucBuf,
+                                         const char *pcName,
+                                         unsigned long ulValue);
+static unsigned int _TFTPStreamPutInfo(unsigned char *pucBuf,
+                                       const tFrameInfo *psInfo);
+static unsigned long _TFTPStreamParseValue(const char *pcValue);
+static tBoolean _TFTPStreamParseOack(unsigned int uiLen);
+static tBoolean _TFTPStreamParseRrq(unsigned int uiLen);
+static tBoolean _TFTPStreamWaitAck(void);
+static tBoolean _TFTPStreamResend(unsigned long ulFirstBlock);
+static tBoolean _TFTPStreamSendBlock(void);
+
+
+//*****************************************************************************
+// Function Implementations
+//*****************************************************************************
+void TFTPStreamSetOptions(unsigned int uiBlockSize, unsigned int uiWindowSize)
+{
+    if(uiBlockSize < _TFTP_MIN_BLOCK_SIZE)
+    {
+        uiBlockSize = TFTP_STREAM_BLOCK_SIZE;
+    }
+    else if(uiBlockSize > TFTP_STREAM_BLOCK_SIZE_MAX)
+    {
+        uiBlockSize = TFTP_STREAM_BLOCK_SIZE_MAX;
+    }
+
+    if(uiWindowSize < 1)
+    {
+        uiWindowSize = 1;
+    }
+    else if(uiWindowSize > TFTP_STREAM_WINDOW_SIZE_MAX)
+    {
+        uiWindowSize = TFTP_STREAM_WINDOW_SIZE_MAX;
+    }
+
+    _uiReqBlockSize = uiBlockSize;
+    _uiReqWindowSize = uiWindowSize;
+}
+
+void TFTPStreamGetOptions(unsigned int *puiBlockSize,
+                          unsigned int *puiWindowSize)
+{
+    *puiBlockSize = _uiBlockSize;
+    *puiWindowSize = _uiWindowSize;
+}
+
+tBoolean TFTPStreamOpen(unsigned long ulServerIP, const char *pcFileName,
+                        unsigned long ulTransferSize, const tFrameInfo *psInfo)
+{
+    tBoolean bOptions;
+    tBoolean bRefused;
+
+    if(!_TFTPStreamSocket())
+    {
+        return 0;
+    }
+
+    _sServerAddr.sin_family = SL_AF_INET;
+    _sServerAddr.sin_addr.s_addr = sl_Htonl(ulServerIP);
+
+    bOptions = (_uiReqBlockSize != TFTP_STREAM_BLOCK_SIZE) ||
+               (_uiReqWindowSize > 1) || (ulTransferSize > 0) ||
+               (psInfo != NULL);
+
+    if(!_TFTPStreamRequest(pcFileName, ulTransferSize, psInfo, bOptions,
+                           &bRefused))
+    {
+        // Servers without option support may reject the request outright
+        if(!bOptions || !bRefused ||
+           !_TFTPStreamRequest(pcFileName, 0, NULL, 0, &bRefused))
+        {
+            TFTPStreamAbort();
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+tBoolean TFTPStreamListen(unsigned short usPort)
+{
+    SlSockAddrIn_t sAddr;
+
+    _sListenSocket = sl_Socket(SL_AF_INET, SL_SOCK_DGRAM, SL_IPPROTO_UDP);
+    if(_sListenSocket < 0)
+    {
+        return 0;
+    }
+
+    sAddr.sin_family = SL_AF_INET;
+    sAddr.sin_port = sl_Htons(usPort);
+    sAddr.sin_addr.s_addr = 0;
+
+    if(sl_Bind(_sListenSocket, (SlSockAddr_t *)&sAddr,
+               sizeof(SlSockAddrIn_t)) < 0)
+    {
+        sl_Close(_sListenSocket);
+        _sListenSocket = -1;
+        return 0;
+    }
+
+    return 1;
+}
+
+tBoolean TFTPStreamAccept(void)
+{
+    SlSocklen_t sFromLen = sizeof(SlSockAddrIn_t);
+    SlSockAddrIn_t sFromAddr;
+    short sRecvLen;
+
+    if(_sListenSocket < 0)
+    {
+        return 0;
+    }
+
+    // Requests queue up on the listening socket while a file is served
+    sRecvLen = sl_RecvFrom(_sListenSocket, _ucRespBuf, sizeof(_ucRespBuf), 0,
+                           (SlSockAddr_t *)&sFromAddr, &sFromLen);
+    if(sRecvLen < 0)
+    {
+        return 0;
+    }
+
+    // A client sends its request again until the first answer, which only
+    // comes once the frame is captured. The copies are queued by the time
+    // the transfer ends and are dropped here rather than served to a client
+    // that has moved on. Later requests from the same port are new ones.
+    if((sFromAddr.sin_addr.s_addr == _sLastClientAddr.sin_addr.s_addr) &&
+       (sFromAddr.sin_port == _sLastClientAddr.sin_port) &&
+       (ClockGetMs() - _ulLastClientMs < TFTP_STREAM_DUP_WINDOW_MS))
+    {
+        return 0;
+    }
+
+    if(!_TFTPStreamParseRrq(sRecvLen))
+    {
+        return 0;
+    }
+    _sServerAddr = sFromAddr;
+    _sLastClientAddr = sFromAddr;
+    _ulLastClientMs = ClockGetMs();
+
+    // The transfer runs on a port of its own (our TID)
+    if(!_TFTPStreamSocket())
+    {
+        return 0;
+    }
+    _bLatchPort = 0;
+
+    return 1;
+}
+
+tBoolean TFTPStreamRespond(unsigned long ulTransferSize,
+                           const tFrameInfo *psInfo)
+{
+    unsigned char ucOack[_TFTP_RQ_BUF_SIZE];
+    unsigned int uiLen = 0;
+    short sRecvLen;
+    int iAttempts = 0;
+
+    if(_sSocket < 0)
+    {
+        return 0;
+    }
+
+    // Without options the first DATA block answers the request
+    if(_ucReqOptions == 0)
+    {
+        return 1;
+    }
+
+    ucOack[uiLen++] = 0;
+    ucOack[uiLen++] = _TFTP_OP_OACK;
+    if(_ucReqOptions & _TFTP_REQ_BLKSIZE)
+    {
+        uiLen += _TFTPStreamPutOption(ucOack+uiLen, _TFTP_OPTION_BLKSIZE,
+                                      _uiBlockSize);
+    }
+    if(_ucReqOptions & _TFTP_REQ_TSIZE)
+    {
+        uiLen += _TFTPStreamPutOption(ucOack+uiLen, _TFTP_OPTION_TSIZE,
+                                      ulTransferSize);
+    }
+    if(_ucReqOptions & _TFTP_REQ_WINDOWSIZE)
+    {
+        uiLen += _TFTPStreamPutOption(ucOack+uiLen, _TFTP_OPTION_WINDOWSIZE,
+                                      _uiWindowSize);
+    }
+    if((_ucReqOptions & _TFTP_REQ_INFO) && (psInfo != NULL))
+    {
+        uiLen += _TFTPStreamPutInfo(ucOack+uiLen, psInfo);
+    }
+
+    if(!_TFTPStreamSend(ucOack, uiLen))
+    {
+        return 0;
+    }
+
+    // The client takes the options with ACK 0
+    while(iAttempts <= TFTP_STREAM_RESEND_LIMIT)
+    {
+        sRecvLen = _TFTPStreamRecv();
+
+        if(sRecvLen < 0)
+        {
+            iAttempts++;
+            if((iAttempts <= TFTP_STREAM_RESEND_LIMIT) &&
+               !_TFTPStreamSend(ucOack, uiLen))
+            {
+                return 0;
+            }
+            continue;
+        }
+
+        if((sRecvLen < _TFTP_HEADER_SIZE) || (_ucRespBuf[0] != 0) ||
+           (_ucRespBuf[1] == _TFTP_OP_ERROR))
+        {
+            return 0;
+        }
+
+        if((_ucRespBuf[1] == _TFTP_OP_ACK) && (_ucRespBuf[2] == 0) &&
+           (_ucRespBuf[3] == 0))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+void TFTPStreamReject(const char *pcMessage)
+{
+    unsigned char ucError[_TFTP_HEADER_SIZE + 64];
+    unsigned int uiLen = strlen(pcMessage) + 1;
+
+    if(_sSocket < 0)
+    {
+        return;
+    }
+
+    if(uiLen > sizeof(ucError) - _TFTP_HEADER_SIZE)
+    {
+        uiLen = sizeof(ucError) - _TFTP_HEADER_SIZE;
+    }
+
+    ucError[0] = 0;
+    ucError[1] = _TFTP_OP_ERROR;
+    ucError[2] = 0;
+    ucError[3] = _TFTP_ERROR_NOT_DEFINED;
+    memcpy(ucError+_TFTP_HEADER_SIZE, pcMessage, uiLen);
+    ucError[_TFTP_HEADER_SIZE+uiLen-1] = 0;
+
+    // Not acknowledged, the client would time out anyway
+    _TFTPStreamSend(ucError, _TFTP_HEADER_SIZE + uiLen);
+    TFTPStreamAbort();
+}
+
+tBoolean TFTPStreamWrite(const unsigned char *pucBuf, unsigned int uiLen)
+{
+    unsigned int uiCopyLen;
+
+    if(_sSocket < 0)
+    {
+        return 0;
+    }
+
+    while(uiLen > 0)
+    {
+        uiCopyLen = _uiBlockSize - _uiFillLen;
+        if(uiCopyLen > uiLen)
+        {
+            uiCopyLen = uiLen;
+        }
+
+        memcpy(&_TFTP_BLOCK_BUF(_ulNextBlock)[_TFTP_HEADER_SIZE+_uiFillLen],
+               pucBuf, uiCopyLen);
+        _uiFillLen += uiCopyLen;
+        pucBuf += uiCopyLen;
+        uiLen -= uiCopyLen;
+
+        // A full block goes out as soon as the window has room, which by
+        // now has usually already happened
+        if(_uiFillLen == _uiBlockSize)
+        {
+            if(!_TFTPStreamSendBlock())
+            {
+                TFTPStreamAbort();
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+tBoolean TFTPStreamClose(void)
+{
+    tBoolean bStatus;
+
+    if(_sSocket < 0)
+    {
+        return 0;
+    }
+
+    // The final block is always shorter than a full block, possibly empty
+    bStatus = _TFTPStreamSendBlock();
+    while(bStatus && (_ulAckedBlock != (_ulNextBlock - 1)))
+    {
+        bStatus = _TFTPStreamWaitAck();
+    }
+
+    TFTPStreamAbort();
+
+    return bStatus;
+}
+
+void TFTPStreamAbort(void)
+{
+    if(_sSocket >= 0)
+    {
+        sl_Close(_sSocket);
+        _sSocket = -1;
+
+        // Copies of a served request are only dropped shortly after it
+        _ulLastClientMs = ClockGetMs();
+    }
+}
+
+static tBoolean _TFTPStreamSocket(void)
+{
+    SlTimeval_t sTimeout;
+
+    _sSocket = sl_Socket(SL_AF_INET, SL_SOCK_DGRAM, SL_IPPROTO_UDP);
+    if(_sSocket < 0)
+    {
+        return 0;
+    }
+
+    sTimeout.tv_sec = TFTP_STREAM_TIMEOUT_MS / 1000;
+    sTimeout.tv_usec = (TFTP_STREAM_TIMEOUT_MS % 1000) * 1000;
+    sl_SetSockOpt(_sSocket, SL_SOL_SOCKET, SL_SO_RCVTIMEO, &sTimeout,
+                  sizeof(sTimeout));
+
+    _uiFillLen = 0;
+    _ulNextBlock = 1;
+    _ulAckedBlock = 0;
+    _bDupAckResent = 0;
+
+    return 1;
+}
+
+static tBoolean _TFTPStreamSend(const unsigned char *pucPacket,
+                                unsigned int uiLen)
+{
+    return sl_SendTo(_sSocket, pucPacket, uiLen, 0,
+                     (SlSockAddr_t *)&_sServerAddr,
+                     sizeof(SlSockAddrIn_t)) == (short)uiLen;
+}
+
+static short _TFTPStreamRecv(void)
+{
+    SlSockAddrIn_t sFromAddr;
+    SlSocklen_t sFromLen;
+    short sRecvLen;
+
+    while(1)
+    {
+        sFromLen = sizeof(SlSockAddrIn_t);
+        sRecvLen = sl_RecvFrom(_sSocket, _ucRespBuf, sizeof(_ucRespBuf), 0,
+                               (SlSockAddr_t *)&sFromAddr, &sFromLen);
+        if(sRecvLen < 0)
+        {
+            return -1;
+        }
+
+        // Ignore packets from anyone but the server
+        if(sFromAddr.sin_addr.s_addr != _sServerAddr.sin_addr.s_addr)
+        {
+            continue;
+        }
+
+        // The server answers a request from a new port (its TID)
+        if(_bLatchPort)
+        {
+            _sServerAddr.sin_port = sFromAddr.sin_port;
+            _bLatchPort = 0;
+        }
+        else if(sFromAddr.sin_port != _sServerAddr.sin_port)
+        {
+            continue;
+        }
+
+        return sRecvLen;
+    }
+}
+
+static tBoolean _TFTPStreamRequest(const char *pcFileName,
+                                   unsigned long ulTransferSize,
+                                   const tFrameInfo *psInfo,
+                                   tBoolean bOptions, tBoolean *pbRefused)
+{
+    unsigned char ucRequest[_TFTP_RQ_BUF_SIZE];
+    unsigned int uiFileNameLen = strlen(pcFileName);
+    unsigned int uiLen = 0;
+    short sRecvLen;
+    int iAttempts = 0;
+
+    *pbRefused = 0;
+
+    if((2 + uiFileNameLen + 1 + sizeof(_TFTP_MODE) +
+        _TFTP_OPTIONS_MAX_LEN) > sizeof(ucRequest))
+    {
+        return 0;
+    }
+
+    // Form WRQ: opcode, file name, 0, mode, 0, then name, 0, value, 0 for
+    // each option
+    ucRequest[uiLen++] = 0;
+    ucRequest[uiLen++] = _TFTP_OP_WRQ;
+    memcpy(ucRequest+uiLen, pcFileName, uiFileNameLen+1);
+    uiLen += uiFileNameLen+1;
+    memcpy(ucRequest+uiLen, _TFTP_MODE, sizeof(_TFTP_MODE));
+    uiLen += sizeof(_TFTP_MODE);
+
+    if(bOptions && (_uiReqBlockSize != TFTP_STREAM_BLOCK_SIZE))
+    {
+        uiLen += _TFTPStreamPutOption(ucRequest+uiLen, _TFTP_OPTION_BLKSIZE,
+                                      _uiReqBlockSize);
+    }
+    if(bOptions && (ulTransferSize > 0))
+    {
+        uiLen += _TFTPStreamPutOption(ucRequest+uiLen, _TFTP_OPTION_TSIZE,
+                                      ulTransferSize);
+    }
+    if(bOptions && (_uiReqWindowSize > 1))
+    {
+        uiLen += _TFTPStreamPutOption(ucRequest+uiLen,
+                                      _TFTP_OPTION_WINDOWSIZE,
+                                      _uiReqWindowSize);
+    }
+    if(bOptions && (psInfo != NULL))
+    {
+        uiLen += _TFTPStreamPutInfo(ucRequest+uiLen, psInfo);
+    }
+
+    // What a server that ignores the options will use
+    _uiBlockSize = TFTP_STREAM_BLOCK_SIZE;
+    _uiWindowSize = 1;
+
+    _sServerAddr.sin_port = sl_Htons(TFTP_STREAM_PORT);
+    _bLatchPort = 1;
+
+    if(!_TFTPStreamSend(ucRequest, uiLen))
+    {
+        return 0;
+    }
+
+    while(iAttempts <= TFTP_STREAM_RESEND_LIMIT)
+    {
+        sRecvLen = _TFTPStreamRecv();
+
+        // Timed out, re-send the request
+        if(sRecvLen < 0)
+        {
+            iAttempts++;
+            if((iAttempts <= TFTP_STREAM_RESEND_LIMIT) &&
+               !_TFTPStreamSend(ucRequest, uiLen))
+            {
+                return 0;
+            }
+            continue;
+        }
+
+        if((sRecvLen < 2) || (_ucRespBuf[0] != 0))
+        {
+            return 0;
+        }
+
+        switch(_ucRespBuf[1])
+        {
+        case _TFTP_OP_ACK:
+            return (sRecvLen >= _TFTP_HEADER_SIZE) && (_ucRespBuf[2] == 0) &&
+                   (_ucRespBuf[3] == 0);
+        case _TFTP_OP_OACK:
+            return _TFTPStreamParseOack(sRecvLen);
+        case _TFTP_OP_ERROR:
+            *pbRefused = 1;
+            return 0;
+        default:
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+static unsigned int _TFTPStreamPutOption(unsigned char *pucBuf,
+                                         const char *pcName,
+                                         unsigned long ulValue)
+{
+    unsigned int uiLen = strlen(pcName) + 1;
+    unsigned int uiDigits = 1;
+    unsigned long ulDiv;
+    unsigned int i;
+
+    memcpy(pucBuf, pcName, uiLen);
+
+    for(ulDiv = ulValue; ulDiv >= 10; ulDiv /= 10)
+    {
+        uiDigits++;
+    }
+
+    // Value as a decimal string
+    uiLen += uiDigits;
+    pucBuf[uiLen] = 0;
+    for(i=1; i<=uiDigits; i++)
+    {
+        pucBuf[uiLen-i] = '0' + (ulValue % 10);
+        ulValue /= 10;
+    }
+
+    return uiLen + 1;
+}
+
+static unsigned int _TFTPStreamPutInfo(unsigned char *pucBuf,
+                                       const tFrameInfo *psInfo)
+{
+    unsigned int uiLen = 0;
+
+    uiLen += _TFTPStreamPutOption(pucBuf+uiLen, _TFTP_OPTION_SEQ,
+                                  psInfo->uiSeq);
+    uiLen += _TFTPStreamPutOption(pucBuf+uiLen, _TFTP_OPTION_CAPTURE_START,
+                                  psInfo->ulCaptureStart);
+    uiLen += _TFTPStreamPutOption(pucBuf+uiLen, _TFTP_OPTION_LENGTH_READ,
+                                  psInfo->ulLengthRead);
+    uiLen += _TFTPStreamPutOption(pucBuf+uiLen, _TFTP_OPTION_READ_DONE,
+                                  psInfo->ulReadDone);
+    uiLen += _TFTPStreamPutOption(pucBuf+uiLen, _TFTP_OPTION_PREV_SENT,
+                                  psInfo->ulPrevSent);
+    uiLen += _TFTPStreamPutOption(pucBuf+uiLen, _TFTP_OPTION_FLAGS,
+                                  psInfo->ucFlags);
+
+    return uiLen;
+}
+
+static unsigned long _TFTPStreamParseValue(const char *pcValue)
+{
+    unsigned long ulValue = 0;
+
+    while((*pcValue >= '0') && (*pcValue <= '9'))
+    {
+        ulValue = (ulValue * 10) + (*pcValue++ - '0');
+    }
+
+    return ulValue;
+}
+
+static tBoolean _TFTPStreamParseOack(unsigned int uiLen)
+{
+    unsigned int uiPos = 2;
+    const char *pcName;
+    const char *pcValue;
+    unsigned long ulValue;
+
+    // Every option must be terminated inside the packet
+    if((uiLen <= uiPos) || (_ucRespBuf[uiLen-1] != 0))
+    {
+        return 0;
+    }
+
+    while(uiPos < uiLen)
+    {
+        pcName = (const char *)&_ucRespBuf[uiPos];
+        uiPos += strlen(pcName) + 1;
+        if(uiPos >= uiLen)
+        {
+            return 0;
+        }
+
+        pcValue = (const char *)&_ucRespBuf[uiPos];
+        uiPos += strlen(pcValue) + 1;
+        ulValue = _TFTPStreamParseValue(pcValue);
+
+        // The server may only lower what was asked for
+        if(!strcmp(pcName, _TFTP_OPTION_BLKSIZE))
+        {
+            if((ulValue < _TFTP_MIN_BLOCK_SIZE) || (ulValue > _uiReqBlockSize))
+            {
+                return 0;
+            }
+            _uiBlockSize = ulValue;
+        }
+        else if(!strcmp(pcName, _TFTP_OPTION_WINDOWSIZE))
+        {
+            if((ulValue < 1) || (ulValue > _uiReqWindowSize))
+            {
+                return 0;
+            }
+            _uiWindowSize = ulValue;
+        }
+    }
+
+    return 1;
+}
+
+static tBoolean _TFTPStreamParseRrq(unsigned int uiLen)
+{
+    unsigned int uiPos = 2;
+    unsigned int uiField;
+    const char *pcName;
+    const char *pcValue;
+    unsigned long ulValue;
+
+    // Opcode, then file name and mode, all terminated inside the packet
+    if((uiLen <= uiPos) || (_ucRespBuf[0] != 0) ||
+       (_ucRespBuf[1] != _TFTP_OP_RRQ) || (_ucRespBuf[uiLen-1] != 0))
+    {
+        return 0;
+    }
+
+    // There is only one file, the next frame, whatever it is called
+    for(uiField = 0; uiField < 2; uiField++)
+    {
+        uiPos += strlen((const char *)&_ucRespBuf[uiPos]) + 1;
+        if(uiPos > uiLen)
+        {
+            return 0;
+        }
+    }
+
+    // What a client that asks for no options will get
+    _ucReqOptions = 0;
+    _uiBlockSize = TFTP_STREAM_BLOCK_SIZE;
+    _uiWindowSize = 1;
+
+    while(uiPos < uiLen)
+    {
+        pcName = (const char *)&_ucRespBuf[uiPos];
+        uiPos += strlen(pcName) + 1;
+        if(uiPos >= uiLen)
+        {
+            break;
+        }
+
+        pcValue = (const char *)&_ucRespBuf[uiPos];
+        uiPos += strlen(pcValue) + 1;
+        ulValue = _TFTPStreamParseValue(pcValue);
+
+        // Lowered to what this side was set up for, unknown ones are left
+        // out of the OACK
+        if(!strcmp(pcName, _TFTP_OPTION_BLKSIZE) &&
+           (ulValue >= _TFTP_MIN_BLOCK_SIZE))
+        {
+            _uiBlockSize = (ulValue < _uiReqBlockSize) ? ulValue :
+                                                         _uiReqBlockSize;
+            _ucReqOptions |= _TFTP_REQ_BLKSIZE;
+        }
+        else if(!strcmp(pcName, _TFTP_OPTION_TSIZE))
+        {
+            _ucReqOptions |= _TFTP_REQ_TSIZE;
+        }
+        else if(!strcmp(pcName, _TFTP_OPTION_WINDOWSIZE) && (ulValue >= 1))
+        {
+            _uiWindowSize = (ulValue < _uiReqWindowSize) ? ulValue :
+                                                           _uiReqWindowSize;
+            _ucReqOptions |= _TFTP_REQ_WINDOWSIZE;
+        }
+        else if(!strcmp(pcName, _TFTP_OPTION_SEQ))
+        {
+            _ucReqOptions |= _TFTP_REQ_INFO;
+        }
+    }
+
+    return 1;
+}
+
+static tBoolean _TFTPStreamWaitAck(void)
+{
+    unsigned long ulAckBlock;
+    unsigned short usAckNum;
+    short sRecvLen;
+    int iAttempts = 0;
+
+    while(iAttempts <= TFTP_STREAM_RESEND_LIMIT)
+    {
+        sRecvLen = _TFTPStreamRecv();
+
+        // Timed out, re-send every block that waits to be acknowledged
+        if(sRecvLen < 0)
+        {
+            iAttempts++;
+            if((iAttempts <= TFTP_STREAM_RESEND_LIMIT) &&
+               !_TFTPStreamResend(_ulAckedBlock+1))
+            {
+                return 0;
+            }
+            continue;
+        }
+
+        if((sRecvLen < _TFTP_HEADER_SIZE) || (_ucRespBuf[0] != 0) ||
+           (_ucRespBuf[1] == _TFTP_OP_ERROR))
+        {
+            return 0;
+        }
+
+        if(_ucRespBuf[1] != _TFTP_OP_ACK)
+        {
+            continue;
+        }
+
+        // Block numbers on the wire wrap at 16 bits
+        usAckNum = (_ucRespBuf[2] << 8) | _ucRespBuf[3];
+        ulAckBlock = _ulAckedBlock +
+                     (unsigned short)(usAckNum - (unsigned short)_ulAckedBlock);
+
+        // The server repeats its last ACK when the first block of a window
+        // is lost, so the window goes out again once. Later repeats are
+        // ignored, not answered, to avoid the Sorcerer's Apprentice problem.
+        if(ulAckBlock == _ulAckedBlock)
+        {
+            if(!_bDupAckResent && (ulAckBlock < (_ulNextBlock - 1)))
+            {
+                _bDupAckResent = 1;
+                if(!_TFTPStreamResend(ulAckBlock+1))
+                {
+                    return 0;
+                }
+            }
+            continue;
+        }
+
+        if(ulAckBlock >= _ulNextBlock)
+        {
+            continue;
+        }
+
+        _ulAckedBlock = ulAckBlock;
+        _bDupAckResent = 0;
+
+        // The server lost a block inside the window, go back to it
+        if((ulAckBlock < (_ulNextBlock - 1)) &&
+           !_TFTPStreamResend(ulAckBlock+1))
+        {
+            return 0;
+        }
+
+        return 1;
+    }
+
+    return 0;
+}
+
+static tBoolean _TFTPStreamResend(unsigned long ulFirstBlock)
+{
+    unsigned long ulBlock;
+
+    for(ulBlock = ulFirstBlock; ulBlock < _ulNextBlock; ulBlock++)
+    {
+        if(!_TFTPStreamSend(_TFTP_BLOCK_BUF(ulBlock),
+                            _uiBlockLen[ulBlock % _TFTP_NUM_BLOCKS]))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static tBoolean _TFTPStreamSendBlock(void)
+{
+    unsigned char *pucBlock = _TFTP_BLOCK_BUF(_ulNextBlock);
+    unsigned int uiBlockLen = _TFTP_HEADER_SIZE + _uiFillLen;
+
+    // Wait while a whole window is on the air
+    while((_ulNextBlock - _ulAckedBlock - 1) >= _uiWindowSize)
+    {
+        if(!_TFTPStreamWaitAck())
+        {
+            return 0;
+        }
+    }
+
+    pucBlock[0] = 0;
+    pucBlock[1] = _TFTP_OP_DATA;
+    pucBlock[2] = (_ulNextBlock >> 8) & 0xFF;
+    pucBlock[3] = _ulNextBlock & 0xFF;
+
+    if(!_TFTPStreamSend(pucBlock, uiBlockLen))
+    {
+        return 0;
+    }
+
+    // Keep the sent block for re-sending and fill the next one
+    _uiBlockLen[_ulNextBlock % _TFTP_NUM_BLOCKS] = uiBlockLen;
+    _uiFillLen = 0;
+    _ulNextBlock++;
+
+    return 1;
+}
@@ -0,0 +1,74 @@
+//*****************************************************************************
+//
+// tftp_stream.h
+//
+// API for uploading a file to a TFTP server while it is still being produced,
+// or for serving it to a client that asked for it with a read request.
+// Larger blocks and several blocks per ACK are negotiated with the server
+// (RFC 2347/2348/7440) when it supports them.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef _TFTP_STREAM_H_
+#define _TFTP_STREAM_H_
+
+
+//*****************************************************************************
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+//*****************************************************************************
+// Defines
+//*****************************************************************************
+#define TFTP_STREAM_PORT                    69
+#define TFTP_STREAM_BLOCK_SIZE              512     // RFC 1350 block size
+#define TFTP_STREAM_BLOCK_SIZE_MAX          1428    // Fits an Ethernet MTU
+#define TFTP_STREAM_WINDOW_SIZE_MAX         4       // Blocks per ACK
+#define TFTP_STREAM_TIMEOUT_MS              2000
+#define TFTP_STREAM_RESEND_LIMIT            3
+#define TFTP_STREAM_DUP_WINDOW_MS           (TFTP_STREAM_TIMEOUT_MS * \
+                                             TFTP_STREAM_RESEND_LIMIT)
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+extern void TFTPStreamSetOptions(unsigned int uiBlockSize,
+                                 unsigned int uiWindowSize);
+extern void TFTPStreamGetOptions(unsigned int *puiBlockSize,
+                                 unsigned int *puiWindowSize);
+extern tBoolean TFTPStreamOpen(unsigned long ulServerIP,
+                               const char *pcFileName,
+                               unsigned long ulTransferSize,
+                               const tFrameInfo *psInfo);
+extern tBoolean TFTPStreamListen(unsigned short usPort);
+extern tBoolean TFTPStreamAccept(void);
+extern tBoolean TFTPStreamRespond(unsigned long ulTransferSize,
+                                  const tFrameInfo *psInfo);
+extern void TFTPStreamReject(const char *pcMessage);
+extern tBoolean TFTPStreamWrite(const unsigned char *pucBuf,
+                                unsigned int uiLen);
+extern tBoolean TFTPStreamClose(void);
+extern void TFTPStreamAbort(void);
+
+
+//*****************************************************************************
+// Mark the end of the C bindings section for C++ compilers.
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TFTP_STREAM_H_ */
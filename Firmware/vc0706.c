@@ -8,18 +8,13 @@
 // December 4, 2015
 //
 // Modified:
-// December 19, 2015
+// October 17, 2026
 //
 //*****************************************************************************
 
-#include "hw_memmap.h"
 #include "hw_types.h"
-#include "prcm.h"
-#include "rom_map.h"
-#include "uart.h"
-#include "utils.h"
-#include "uart_if.h"
 #include "gpio_if.h"
+#include "vc0706_uart.h"
 
 #include "vc0706.h"
 
@@ -27,12 +22,34 @@ void VC0706InitDriver()
 {
     _ucSerialNum = 0;
 
-    MAP_UARTConfigSetExpClk(VC0706, MAP_PRCMPeripheralClockGet(VC0706_PERIPH),
-                            VC0706_DEFAULT_BAUD_RATE,
-                            (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
-                            UART_CONFIG_PAR_NONE));
+    VC0706UartInit(VC0706_DEFAULT_BAUD_RATE);
+}
+
+void VC0706SetDriverBaudRate(unsigned long ulBaudRate)
+{
+    VC0706UartSetBaudRate(ulBaudRate);
 
-    MAP_UARTEnable(VC0706);
+    // Anything received around the switch is garbage
+    VC0706UartFlush();
+}
+
+tBoolean VC0706GetVersion(void)
+{
+    unsigned char ucArgs[] = {0x01};
+    unsigned char ucRespLen = 5;
+    unsigned char ucVersionLen;
+
+    if(!_VC0706RunCommand(VC0706_COMMAND_GEN_VERSION, ucArgs,
+                          sizeof(ucArgs), ucRespLen, 1))
+    {
+        return 0;
+    }
+
+    // Version string, e.g. "VC0703 1.00"
+    ucVersionLen = _ucCameraBuf[4];
+
+    return _VC0706ReadResponse(ucVersionLen, _VC0706_COMMAND_TIMEOUT) ==
+           ucVersionLen;
 }
 
 tBoolean VC0706SystemReset()
@@ -73,6 +90,25 @@ tBoolean VC0706SetImageSize(unsigned char ucImageSize)
                              sizeof(ucArgs), ucRespLen, 0);
 }
 
+tBoolean VC0706SetDownsize(unsigned char ucDownsize)
+{
+    unsigned char ucArgs[] = {0x01, ucDownsize};
+    unsigned char ucRespLen = 5;
+
+    // Unlike the image size, applies to the next frame without a reset
+    return _VC0706RunCommand(VC0706_COMMAND_DOWNSIZE_CTRL, ucArgs,
+                             sizeof(ucArgs), ucRespLen, 0);
+}
+
+tBoolean VC0706SetCompression(unsigned char ucCompression)
+{
+    unsigned char ucArgs[] = {0x05, 0x01, 0x01, 0x12, 0x04, ucCompression};
+    unsigned char ucRespLen = 5;
+
+    return _VC0706RunCommand(VC0706_COMMAND_WRITE_DATA, ucArgs,
+                             sizeof(ucArgs), ucRespLen, 0);
+}
+
 tBoolean VC0706SetFrameControl(unsigned char ucCtrlFlag)
 {
     unsigned char ucArgs[] = {0x01, ucCtrlFlag};
@@ -82,10 +118,10 @@ tBoolean VC0706SetFrameControl(unsigned char ucCtrlFlag)
                              sizeof(ucArgs), ucRespLen, 0);
 }
 
-unsigned int VC0706GetFrameLength(void)
+unsigned int VC0706GetFrameLength(unsigned char ucFrameType)
 {
     unsigned int uiFrameLen;
-    unsigned char ucArgs[] = {0x01, VC0706_CURRENT_FRAME};
+    unsigned char ucArgs[] = {0x01, ucFrameType};
     unsigned char ucRespLen = 9;
 
     if(!_VC0706RunCommand(VC0706_COMMAND_GET_FBUF_LEN, ucArgs,
@@ -106,14 +142,77 @@ unsigned int VC0706GetFrameLength(void)
     return uiFrameLen;
 }
 
+tBoolean VC0706SetMotionStatus(unsigned char ucItem, unsigned char ucAlarm,
+                               unsigned char ucActivate)
+{
+    unsigned char ucArgs[] = {0x03, ucItem, ucAlarm, ucActivate};
+    unsigned char ucRespLen = 5;
+
+    return _VC0706RunCommand(VC0706_COMMAND_MOTION_CTRL, ucArgs,
+                             sizeof(ucArgs), ucRespLen, 1);
+}
+
+tBoolean VC0706SetMotionDetect(tBoolean bEnable)
+{
+    unsigned char ucArgs[] = {0x01, bEnable ? 0x01 : 0x00};
+    unsigned char ucRespLen = 5;
+
+    // Report motion over the UART
+    if(bEnable && !VC0706SetMotionStatus(VC0706_MOTION_CONTROL,
+                                         VC0706_MOTION_ALARM_UART,
+                                         VC0706_MOTION_ACTIVATE))
+    {
+        return 0;
+    }
+
+    // Flushing drops alarms that were queued before the switch
+    return _VC0706RunCommand(VC0706_COMMAND_COMM_MOTION_CTRL, ucArgs,
+                             sizeof(ucArgs), ucRespLen, 1);
+}
+
+tBoolean VC0706MotionDetected(unsigned long ulTimeoutMs)
+{
+    unsigned char ucRespLen = 5;
+
+    // The camera sends the alarm on its own while motion is detected. An
+    // alarm cut short by the timeout is skipped on the next call.
+    if(!_VC0706ReadReply(VC0706_COMMAND_COMM_MOTION_DETECTED, ucRespLen,
+                         ulTimeoutMs))
+    {
+        return 0;
+    }
+
+    return _VC0706VerifyResponse(VC0706_COMMAND_COMM_MOTION_DETECTED);
+}
+
 unsigned char *VC0706GetFrameBuffer(unsigned char ucNumBytes,
-                                    unsigned short usOffset)
+                                    unsigned int uiOffset)
+{
+    if(ucNumBytes > _VC0706_CAMERA_BUF_SIZE)
+    {
+        return 0;
+    }
+
+    if(!VC0706ReadFrameBuffer(VC0706_CURRENT_FRAME, _ucCameraBuf, ucNumBytes,
+                              uiOffset, VC0706_CONTROL_MODE_MCU))
+    {
+        return 0;
+    }
+
+    return _ucCameraBuf;
+}
+
+tBoolean VC0706ReadFrameBuffer(unsigned char ucFrameType,
+                               unsigned char *pucDest, unsigned int uiNumBytes,
+                               unsigned int uiOffset, unsigned char ucCtrlMode)
 {
-    unsigned char ucArgs[] = {0x0C, VC0706_CURRENT_FRAME,
-                              VC0706_CONTROL_MODE_MCU,
-                              0x00, 0x00, (usOffset >> 8) & 0xFF,
-                              usOffset & 0xFF, 0x00, 0x00, 0x00,
-                              ucNumBytes, (_VC0706_CAMERA_DELAY >> 8) & 0xFF,
+    unsigned char ucArgs[] = {0x0C, ucFrameType, ucCtrlMode,
+                              (uiOffset >> 24) & 0xFF, (uiOffset >> 16) & 0xFF,
+                              (uiOffset >> 8) & 0xFF, uiOffset & 0xFF,
+                              (uiNumBytes >> 24) & 0xFF,
+                              (uiNumBytes >> 16) & 0xFF,
+                              (uiNumBytes >> 8) & 0xFF, uiNumBytes & 0xFF,
+                              (_VC0706_CAMERA_DELAY >> 8) & 0xFF,
                               _VC0706_CAMERA_DELAY & 0xFF};
     unsigned char ucRespLen = 5;
 
@@ -123,13 +222,21 @@ unsigned char *VC0706GetFrameBuffer(unsigned char ucNumBytes,
         return 0;
     }
 
-    // ucRespLen offset is to account for the end command bytes
-    if(!_VC0706ReadResponse(ucNumBytes+ucRespLen, 200))
+    // Data goes straight to the caller, so the read size is not limited by
+    // the response buffer
+    if(VC0706UartRead(pucDest, uiNumBytes, _VC0706_DATA_TIMEOUT) != uiNumBytes)
     {
         return 0;
     }
 
-    return _ucCameraBuf;
+    // The data is followed by a copy of the response header
+    if(!_VC0706ReadReply(VC0706_COMMAND_READ_FBUF, ucRespLen,
+                         _VC0706_DATA_TIMEOUT))
+    {
+        return 0;
+    }
+
+    return _VC0706VerifyResponse(VC0706_COMMAND_READ_FBUF);
 }
 
 static tBoolean _VC0706RunCommand(unsigned char ucCmd, unsigned char *pucArgs,
@@ -138,12 +245,12 @@ static tBoolean _VC0706RunCommand(unsigned char ucCmd, unsigned char *pucArgs,
 {
     if(bFlush)
     {
-        _VC0706ReadResponse(100, 10);
+        VC0706UartFlush();
     }
 
     _VC0706SendCommand(ucCmd, pucArgs, ucArgn);
 
-    if(_VC0706ReadResponse(ucRespLen, 200) != ucRespLen)
+    if(!_VC0706ReadReply(ucCmd, ucRespLen, _VC0706_COMMAND_TIMEOUT))
     {
         return 0;
     }
@@ -159,42 +266,82 @@ static tBoolean _VC0706RunCommand(unsigned char ucCmd, unsigned char *pucArgs,
 static void _VC0706SendCommand(unsigned char ucCmd, unsigned char *pucArgs,
                                unsigned char ucArgn)
 {
-    int i;
+    unsigned char ucHeader[] = {VC0706_PROTOCOL_SIGN_RECEIVE, _ucSerialNum,
+                                ucCmd};
 
-    MAP_UARTCharPut(VC0706, VC0706_PROTOCOL_SIGN_RECEIVE);
-    MAP_UARTCharPut(VC0706, _ucSerialNum);
-    MAP_UARTCharPut(VC0706, ucCmd);
+    VC0706UartWrite(ucHeader, sizeof(ucHeader));
+    VC0706UartWrite(pucArgs, ucArgn);
+}
 
-    for(i=0; i<ucArgn; i++)
+static tBoolean _VC0706ReadResponse(unsigned char ucNumBytes,
+                                    unsigned char ucTimeout)
+{
+    if(ucNumBytes > _VC0706_CAMERA_BUF_SIZE)
     {
-        MAP_UARTCharPut(VC0706, pucArgs[i]);
+        ucNumBytes = _VC0706_CAMERA_BUF_SIZE;
     }
+
+    // Blocks on the UART ring buffer, ucTimeout is the idle time in ms
+    _ucCameraBufLen = VC0706UartRead(_ucCameraBuf, ucNumBytes, ucTimeout);
+
+    return _ucCameraBufLen;
 }
 
-static tBoolean _VC0706ReadResponse(unsigned char ucNumBytes,
-                                    unsigned char ucTimeout)
+static tBoolean _VC0706ReadReply(unsigned char ucCmd, unsigned char ucRespLen,
+                                 unsigned long ulTimeoutMs)
 {
-    //unsigned char ucCounter = 0;
+    unsigned char ucSkipped = 0;
+    unsigned char ucRestLen;
+
+    if(ucRespLen > _VC0706_CAMERA_BUF_SIZE)
+    {
+        ucRespLen = _VC0706_CAMERA_BUF_SIZE;
+    }
     _ucCameraBufLen = 0;
-    //tBoolean bAvail;
 
-    //while((ucCounter != ucTimeout) && (_ucCameraBufLen != ucNumBytes))
-    while(_ucCameraBufLen != ucNumBytes)
+    while(1)
     {
-        /*bAvail = MAP_UARTCharsAvail(VC0706);
+        // Skip to the sign a reply starts with
+        if(VC0706UartRead(_ucCameraBuf, 1, ulTimeoutMs) != 1)
+        {
+            return 0;
+        }
+        if(_ucCameraBuf[0] != VC0706_PROTOCOL_SIGN_RETURN)
+        {
+            if(++ucSkipped == _VC0706_RESYNC_MAX_BYTES)
+            {
+                return 0;
+            }
+            continue;
+        }
 
-        if(!bAvail)
+        if(VC0706UartRead(_ucCameraBuf+1, _VC0706_REPLY_HEADER_SIZE-1,
+                          _VC0706_COMMAND_TIMEOUT) !=
+           _VC0706_REPLY_HEADER_SIZE-1)
+        {
+            return 0;
+        }
+
+        // Motion alarms keep coming until detection is off, they are not
+        // the reply to another command
+        if((_ucCameraBuf[2] == VC0706_COMMAND_COMM_MOTION_DETECTED) &&
+           (ucCmd != VC0706_COMMAND_COMM_MOTION_DETECTED) &&
+           (_ucCameraBuf[4] == 0))
         {
-            ucCounter++;
-            MAP_UtilsDelay(100);
             continue;
         }
-        ucCounter = 0;*/
+        break;
+    }
 
-        _ucCameraBuf[_ucCameraBufLen++] = MAP_UARTCharGet(VC0706);
+    _ucCameraBufLen = _VC0706_REPLY_HEADER_SIZE;
+    if(ucRespLen > _VC0706_REPLY_HEADER_SIZE)
+    {
+        ucRestLen = ucRespLen - _VC0706_REPLY_HEADER_SIZE;
+        _ucCameraBufLen += VC0706UartRead(_ucCameraBuf+_ucCameraBufLen,
+                                          ucRestLen, _VC0706_COMMAND_TIMEOUT);
     }
 
-    return _ucCameraBufLen;
+    return _ucCameraBufLen == ucRespLen;
 }
 
 static tBoolean _VC0706VerifyResponse(unsigned char ucCmd)
@@ -11,7 +11,7 @@
 // December 4, 2015
 //
 // Modified:
-// December 19, 2015
+// October 17, 2026
 //
 //*****************************************************************************
 
@@ -34,8 +34,10 @@ extern "C"
 //*****************************************************************************
 //#define VC0706                                  UARTA1_BASE
 //#define VC0706_PERIPH                           PRCM_UARTA1
+//#define VC0706_INT                              INT_UARTA1
 #define VC0706                                  UARTA0_BASE
 #define VC0706_PERIPH                           PRCM_UARTA0
+#define VC0706_INT                              INT_UARTA0
 #define VC0706_DEFAULT_BAUD_RATE                38400
 
 #define VC0706_INTERFACE_UART                   0x01
@@ -100,9 +102,16 @@ extern "C"
 #define VC0706_COMMAND_BATCH_WRITE              0x80
 
 #define VC0706_CURRENT_FRAME                    0x00
+#define VC0706_NEXT_FRAME                       0x01
 
 #define VC0706_CURRENT_FRAME_CONTROL_STOP       0x00
+#define VC0706_NEXT_FRAME_CONTROL_STOP          0x01
 #define VC0706_CURRENT_FRAME_CONTROL_RESUME     0x02
+#define VC0706_CURRENT_FRAME_CONTROL_STEP       0x03
+
+#define VC0706_MOTION_CONTROL                   0x00
+#define VC0706_MOTION_ALARM_UART                0x01
+#define VC0706_MOTION_ACTIVATE                  0x01
 
 #define VC0706_CONTROL_MODE_MCU                 0x0A
 #define VC0706_CONTROL_MODE_DMA                 0x0F
@@ -111,8 +120,18 @@ extern "C"
 #define VC0706_IMAGE_SIZE_320_240               0x11
 #define VC0706_IMAGE_SIZE_160_120               0x22
 
+#define VC0706_DOWNSIZE_1_1                     0x00
+#define VC0706_DOWNSIZE_1_2                     0x11    // Width and height
+#define VC0706_DOWNSIZE_1_4                     0x22
+
+#define VC0706_COMPRESSION_DEFAULT              0x36
+
 #define _VC0706_CAMERA_BUF_SIZE                 100
 #define _VC0706_CAMERA_DELAY                    10
+#define _VC0706_COMMAND_TIMEOUT                 200
+#define _VC0706_DATA_TIMEOUT                    200
+#define _VC0706_REPLY_HEADER_SIZE               5
+#define _VC0706_RESYNC_MAX_BYTES                64  // Skipped to find a reply
 
 
 //*****************************************************************************
@@ -127,14 +146,28 @@ static unsigned char _ucCameraBufLen;
 // Function Prototypes
 //*****************************************************************************
 extern void VC0706InitDriver(void);
+extern void VC0706SetDriverBaudRate(unsigned long ulBaudRate);
+extern tBoolean VC0706GetVersion(void);
 extern tBoolean VC0706SystemReset(void);
 extern tBoolean VC0706SetSerialNum(unsigned char ucSerialNum);
 extern tBoolean VC0706SetBaudRate(unsigned short usBaudRate);
 extern tBoolean VC0706SetImageSize(unsigned char ucImageSize);
+extern tBoolean VC0706SetDownsize(unsigned char ucDownsize);
+extern tBoolean VC0706SetCompression(unsigned char ucCompression);
 extern tBoolean VC0706SetFrameControl(unsigned char ucCtrlFlag);
-extern unsigned int VC0706GetFrameLength(void);
+extern unsigned int VC0706GetFrameLength(unsigned char ucFrameType);
+extern tBoolean VC0706SetMotionStatus(unsigned char ucItem,
+                                      unsigned char ucAlarm,
+                                      unsigned char ucActivate);
+extern tBoolean VC0706SetMotionDetect(tBoolean bEnable);
+extern tBoolean VC0706MotionDetected(unsigned long ulTimeoutMs);
 extern unsigned char *VC0706GetFrameBuffer(unsigned char ucNumBytes,
-                                           unsigned short usOffset);
+                                           unsigned int uiOffset);
+extern tBoolean VC0706ReadFrameBuffer(unsigned char ucFrameType,
+                                      unsigned char *pucDest,
+                                      unsigned int uiNumBytes,
+                                      unsigned int uiOffset,
+                                      unsigned char ucCtrlMode);
 static tBoolean _VC0706RunCommand(unsigned char ucCmd, unsigned char *pucArgs,
                                   unsigned char ucArgn, unsigned char ucRespLen,
                                   tBoolean bFlush);
@@ -142,6 +175,8 @@ static void _VC0706SendCommand(unsigned char ucCmd, unsigned char *pucArgs,
                                unsigned char ucArgn);
 static tBoolean _VC0706ReadResponse(unsigned char ucNumBytes,
                                     unsigned char ucTimeout);
+static tBoolean _VC0706ReadReply(unsigned char ucCmd, unsigned char ucRespLen,
+                                 unsigned long ulTimeoutMs);
 static tBoolean _VC0706VerifyResponse(unsigned char ucCmd);
 
 
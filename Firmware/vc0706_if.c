@@ -8,12 +8,11 @@
 // December 5, 2015
 //
 // Modified:
-// December 19, 2015
+// October 17, 2026
 //
 //*****************************************************************************
 
 #include <stddef.h>
-#include <stdlib.h>
 #include <string.h>
 #include "common.h"
 #include "hw_types.h"
@@ -22,14 +21,81 @@
 #include "uart_if.h"
 #include "gpio_if.h"
 #include "vc0706.h"
+#include "clock_if.h"
+#include "osi.h"
 
 #include "vc0706_if.h"
 
-tBoolean CameraInit(unsigned char ucSerialNum, unsigned short usBaudRate,
+
+//*****************************************************************************
+// Types
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulBaudRate;
+    unsigned short usCameraBaud;
+} tCameraBaudRate;
+
+
+//*****************************************************************************
+// Variables
+//*****************************************************************************
+// Highest first. The HS-UART rates need the camera's HS-UART pins, which the
+// Adafruit board does not break out, so only the UART port is negotiated.
+static const tCameraBaudRate _sBaudRates[] =
+{
+    {115200, VC0706_INTERFACE_UART_BAUD_115200},
+    {57600,  VC0706_INTERFACE_UART_BAUD_57600},
+    {38400,  VC0706_INTERFACE_UART_BAUD_38400},
+    {19200,  VC0706_INTERFACE_UART_BAUD_19200},
+    {9600,   VC0706_INTERFACE_UART_BAUD_9600}
+};
+#define _NUM_BAUD_RATES     (sizeof(_sBaudRates)/sizeof(_sBaudRates[0]))
+
+static unsigned long _ulBaudRate = VC0706_DEFAULT_BAUD_RATE;
+static unsigned char _ucCaptureMode = CAMERA_DEFAULT_CAPTURE_MODE;
+static unsigned char _ucFrameType = VC0706_CURRENT_FRAME;
+static tBoolean _bFrameHeld = 0;
+static unsigned char _ucDownsize = VC0706_DOWNSIZE_1_1;
+static unsigned char _ucCompression = VC0706_COMPRESSION_DEFAULT;
+static tCameraStats _sStats;
+static tCameraFrameTimes _sFrameTimes;
+static unsigned long _ulStatsStartMs;
+static unsigned char _ucMotionHits = CAMERA_DEFAULT_MOTION_HITS;
+static unsigned long _ulMotionWindowMs = CAMERA_DEFAULT_MOTION_WINDOW_MS;
+static unsigned int _uiChunkSize = CAMERA_DEFAULT_CHUNK_SIZE;
+static unsigned char _ucCtrlMode = CAMERA_DEFAULT_CTRL_MODE;
+static unsigned char _ucOversizePolicy = CAMERA_DEFAULT_OVERSIZE_POLICY;
+static unsigned char _ucStreamBuf[CAMERA_STREAM_BUF_SIZE];
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+static tBoolean _CameraFrameBegin(unsigned int *puiFrameLen);
+static tBoolean _CameraFrameEnd(unsigned int uiFrameLen);
+static unsigned int _CameraChunkLen(unsigned int uiBytesLeft,
+                                    unsigned int uiMaxLen);
+static tBoolean _CameraVerifyBaudRate(unsigned long ulBaudRate);
+static unsigned int _CameraProbeBaudRate(void);
+static unsigned int _CameraSwitchBaudRate(unsigned int uiFrom,
+                                          unsigned int uiTo);
+
+
+//*****************************************************************************
+// Function Implementations
+//*****************************************************************************
+tBoolean CameraInit(unsigned char ucSerialNum, unsigned long ulBaudRate,
                 unsigned char ucImageSize)
 {
     VC0706InitDriver();
 
+    if(!CameraNegotiateBaudRate(ulBaudRate))
+    {
+        GPIO_IF_LedOn(MCU_GREEN_LED_GPIO);
+        return 0;
+    }
+
     // System reset not working... fix this later..
     /*if(!VC0706SystemReset())
     {
@@ -45,13 +111,21 @@ tBoolean CameraInit(unsigned char ucSerialNum, unsigned short usBaudRate,
         return 0;
     }
 
-    if(!VC0706SetBaudRate(usBaudRate))
+    if(!VC0706SetImageSize(ucImageSize))
     {
-        GPIO_IF_LedOn(MCU_GREEN_LED_GPIO);
+        GPIO_IF_LedOn(MCU_RED_LED_GPIO);
         return 0;
     }
 
-    if(!VC0706SetImageSize(ucImageSize))
+    // The camera keeps these across an MCU reset, start from known values
+    if(!VC0706SetDownsize(_ucDownsize) ||
+       !VC0706SetCompression(_ucCompression))
+    {
+        GPIO_IF_LedOn(MCU_RED_LED_GPIO);
+        return 0;
+    }
+
+    if(!CameraSetCaptureMode(CAMERA_DEFAULT_CAPTURE_MODE))
     {
         GPIO_IF_LedOn(MCU_RED_LED_GPIO);
         return 0;
@@ -60,55 +134,461 @@ tBoolean CameraInit(unsigned char ucSerialNum, unsigned short usBaudRate,
     return 1;
 }
 
-unsigned char *CameraSnapshot(unsigned int *uiFrameLen)
+unsigned long CameraNegotiateBaudRate(unsigned long ulMaxBaudRate)
 {
-    unsigned int uiBytesLeft;
-    unsigned char *pucCameraBuf;
-    unsigned char *pucImageBuf;
-    unsigned char ucBytesToRead;
-    unsigned int uiImageBufOffset = 0;
-    unsigned short usCameraBufOffset = 0;
+    unsigned int uiCurrent;
+    unsigned int i;
 
-    // Stop updating frame
-    if(!VC0706SetFrameControl(VC0706_CURRENT_FRAME_CONTROL_STOP))
+    // Probe the camera's current rate, it keeps it across an MCU reset
+    uiCurrent = _CameraProbeBaudRate();
+    if(uiCurrent == _NUM_BAUD_RATES)
     {
-        *uiFrameLen = 0;
-        return NULL;
+        return 0;
     }
 
-    // Get size of frame
-    *uiFrameLen = VC0706GetFrameLength();
-    uiBytesLeft = *uiFrameLen;
+    // Step up to the highest rate that still passes verification
+    for(i=0; i<uiCurrent; i++)
+    {
+        if(_sBaudRates[i].ulBaudRate > ulMaxBaudRate)
+        {
+            continue;
+        }
+
+        uiCurrent = _CameraSwitchBaudRate(uiCurrent, i);
+        if(uiCurrent == i)
+        {
+            break;
+        }
+
+        // Lost the camera in between, find it again
+        if(uiCurrent == _NUM_BAUD_RATES)
+        {
+            uiCurrent = _CameraProbeBaudRate();
+            if(uiCurrent == _NUM_BAUD_RATES)
+            {
+                return 0;
+            }
+        }
+    }
+
+    _ulBaudRate = _sBaudRates[uiCurrent].ulBaudRate;
+
+    return _ulBaudRate;
+}
+
+unsigned long CameraGetBaudRate(void)
+{
+    return _ulBaudRate;
+}
+
+tBoolean CameraEnableMotion(tBoolean bEnable)
+{
+    int i;
+
+    // Alarms still on the line can be taken for a garbled reply
+    for(i=0; i<CAMERA_MOTION_CTRL_TRIES; i++)
+    {
+        if(VC0706SetMotionDetect(bEnable))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+void CameraSetMotionSensitivity(unsigned char ucHits, unsigned long ulWindowMs)
+{
+    // The camera has no threshold setting, it raises an alarm for every
+    // changed frame. Requiring several alarms close together filters out
+    // flicker and noise, so more hits means less sensitive.
+    _ucMotionHits = ucHits ? ucHits : 1;
+    _ulMotionWindowMs = ulWindowMs;
+}
+
+tBoolean CameraWaitMotion(unsigned long ulTimeoutMs)
+{
+    unsigned long ulStart = ClockGetMs();
+    unsigned long ulFirstHit = 0;
+    unsigned long ulElapsed;
+    unsigned long ulNow;
+    unsigned char ucHits = 0;
+
+    while((ulElapsed = ClockGetMs() - ulStart) < ulTimeoutMs)
+    {
+        if(!VC0706MotionDetected(ulTimeoutMs - ulElapsed))
+        {
+            continue;
+        }
+
+        // Start a new window if the last one ran out
+        ulNow = ClockGetMs();
+        if((ucHits == 0) || ((ulNow - ulFirstHit) > _ulMotionWindowMs))
+        {
+            ulFirstHit = ulNow;
+            ucHits = 0;
+        }
+
+        if(++ucHits >= _ucMotionHits)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+tBoolean CameraSetCaptureMode(unsigned char ucCaptureMode)
+{
+    tBoolean bStatus = 1;
+
+    // Let go of a frame held by step mode
+    if(_bFrameHeld)
+    {
+        bStatus = VC0706SetFrameControl(VC0706_CURRENT_FRAME_CONTROL_RESUME);
+        _bFrameHeld = 0;
+    }
+
+    _ucCaptureMode = ucCaptureMode;
+
+    _sStats.ucCaptureMode = ucCaptureMode;
+    _sStats.uiFrames = 0;
+    _sStats.uiOversized = 0;
+    _sStats.ulBytes = 0;
+    _ulStatsStartMs = ClockGetMs();
+
+    return bStatus;
+}
+
+tBoolean CameraSetQuality(unsigned char ucDownsize,
+                          unsigned char ucCompression)
+{
+    // Cheap to call for every frame, the camera only hears of changes
+    if(ucDownsize != _ucDownsize)
+    {
+        if(!VC0706SetDownsize(ucDownsize))
+        {
+            return 0;
+        }
+        _ucDownsize = ucDownsize;
+    }
+
+    if(ucCompression != _ucCompression)
+    {
+        if(!VC0706SetCompression(ucCompression))
+        {
+            return 0;
+        }
+        _ucCompression = ucCompression;
+    }
+
+    return 1;
+}
+
+void CameraGetStats(tCameraStats *psStats)
+{
+    *psStats = _sStats;
+    psStats->ulElapsedMs = ClockGetMs() - _ulStatsStartMs;
+}
+
+void CameraGetFrameTimes(tCameraFrameTimes *psTimes)
+{
+    *psTimes = _sFrameTimes;
+}
+
+void CameraSetReadMode(unsigned int uiChunkSize, unsigned char ucCtrlMode)
+{
+    _uiChunkSize = uiChunkSize;
+    _ucCtrlMode = ucCtrlMode;
+}
+
+long CameraSnapshot(unsigned char *pucBuf, unsigned int uiBufSize,
+                    unsigned int *puiFrameLen)
+{
+    unsigned int uiOffset = 0;
+    unsigned int uiBytesToRead;
+    unsigned int uiReadLen;
+    long lStatus = CAMERA_STATUS_OK;
+    tBoolean bStatus;
+
+    bStatus = _CameraFrameBegin(puiFrameLen);
+    uiReadLen = *puiFrameLen;
+
+    // Frame does not fit the caller's buffer
+    if(bStatus && (uiReadLen > uiBufSize))
+    {
+        _sStats.uiOversized++;
+        if(_ucOversizePolicy == CAMERA_OVERSIZE_TRUNCATE)
+        {
+            lStatus = CAMERA_STATUS_TRUNCATED;
+            uiReadLen = uiBufSize;
+        }
+        else
+        {
+            lStatus = CAMERA_STATUS_SKIPPED;
+            uiReadLen = 0;
+        }
+    }
+
+    // Get picture, chunks go straight into the image so any chunk size up
+    // to the whole frame can be used
+    while(bStatus && (uiOffset < uiReadLen))
+    {
+        uiBytesToRead = _CameraChunkLen(uiReadLen - uiOffset, uiReadLen);
+
+        bStatus = VC0706ReadFrameBuffer(_ucFrameType, pucBuf+uiOffset,
+                                        uiBytesToRead, uiOffset, _ucCtrlMode);
+        uiOffset += uiBytesToRead;
+    }
 
-    // Allocate memory for snapshot
-    pucImageBuf = malloc(uiBytesLeft);
-    if(pucImageBuf == NULL)
+    if(!_CameraFrameEnd(bStatus ? uiReadLen : 0) || !bStatus)
     {
-        //UART_PRINT("Can't Allocate Resources\r\n");
-        LOOP_FOREVER();
+        *puiFrameLen = 0;
+        return CAMERA_STATUS_ERROR;
     }
 
-    // Get picture
-    while(uiBytesLeft > 0)
+    *puiFrameLen = uiReadLen;
+
+    return lStatus;
+}
+
+void CameraSetOversizePolicy(unsigned char ucPolicy)
+{
+    _ucOversizePolicy = ucPolicy;
+}
+
+tBoolean CameraSnapshotStream(tCameraChunkHandler pfnHandler, void *pvArg,
+                              unsigned int *puiFrameLen)
+{
+    unsigned int uiOffset = 0;
+    unsigned int uiBytesToRead;
+    tBoolean bStatus;
+
+    bStatus = _CameraFrameBegin(puiFrameLen);
+
+    // Hand each chunk to the consumer as soon as it is read, so the consumer
+    // can work on it while the next chunk is being pulled over the UART
+    while(bStatus && (uiOffset < *puiFrameLen))
     {
-        ucBytesToRead = uiBytesLeft>64 ? 64 : uiBytesLeft;
+        uiBytesToRead = _CameraChunkLen(*puiFrameLen - uiOffset,
+                                        CAMERA_STREAM_BUF_SIZE);
 
-        pucCameraBuf = VC0706GetFrameBuffer(ucBytesToRead, usCameraBufOffset);
-        usCameraBufOffset += ucBytesToRead;
+        bStatus = VC0706ReadFrameBuffer(_ucFrameType, _ucStreamBuf,
+                                        uiBytesToRead, uiOffset, _ucCtrlMode);
+        if(bStatus)
+        {
+            bStatus = pfnHandler(_ucStreamBuf, uiBytesToRead, uiOffset,
+                                 *puiFrameLen, pvArg);
+        }
 
-        memcpy(pucImageBuf+uiImageBufOffset, pucCameraBuf, ucBytesToRead);
+        uiOffset += uiBytesToRead;
+    }
+
+    // Resume updating frame, even if the snapshot was aborted
+    if(!_CameraFrameEnd(bStatus ? *puiFrameLen : 0))
+    {
+        bStatus = 0;
+    }
+
+    return bStatus;
+}
 
-        uiImageBufOffset+=ucBytesToRead;
-        uiBytesLeft-=ucBytesToRead;
+unsigned int CameraBenchmarkReadMode(const unsigned int *puiChunkSizes,
+                                     unsigned int uiNumSizes,
+                                     unsigned char ucCtrlMode,
+                                     unsigned int uiNumFrames,
+                                     unsigned char *pucBuf,
+                                     unsigned int uiBufSize,
+                                     tCameraBenchResult *psResults)
+{
+    unsigned int uiSaveChunkSize = _uiChunkSize;
+    unsigned char ucSaveCtrlMode = _ucCtrlMode;
+    unsigned int uiBest = 0;
+    unsigned int uiFrameLen;
+    unsigned long ulStart;
+    unsigned int i, j;
+
+    for(i=0; i<uiNumSizes; i++)
+    {
+        CameraSetReadMode(puiChunkSizes[i], ucCtrlMode);
+
+        psResults[i].uiChunkSize = puiChunkSizes[i];
+        psResults[i].uiFrames = 0;
+        psResults[i].ulBytes = 0;
+
+        ulStart = ClockGetMs();
+        for(j=0; j<uiNumFrames; j++)
+        {
+            if(CameraSnapshot(pucBuf, uiBufSize, &uiFrameLen) !=
+               CAMERA_STATUS_OK)
+            {
+                break;
+            }
+
+            psResults[i].uiFrames++;
+            psResults[i].ulBytes += uiFrameLen;
+        }
+        psResults[i].ulElapsedMs = ClockGetMs() - ulStart;
+
+        // Compare bytes per ms without dividing: a/b > c/d <=> a*d > c*b
+        if((unsigned long long)psResults[i].ulBytes *
+           psResults[uiBest].ulElapsedMs >
+           (unsigned long long)psResults[uiBest].ulBytes *
+           psResults[i].ulElapsedMs)
+        {
+            uiBest = i;
+        }
+    }
+
+    CameraSetReadMode(uiSaveChunkSize, ucSaveCtrlMode);
+
+    return uiBest;
+}
+
+static tBoolean _CameraVerifyBaudRate(unsigned long ulBaudRate)
+{
+    int i;
+
+    VC0706SetDriverBaudRate(ulBaudRate);
+
+    for(i=0; i<CAMERA_BAUD_VERIFY_TRIES; i++)
+    {
+        if(VC0706GetVersion())
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static unsigned int _CameraProbeBaudRate(void)
+{
+    unsigned int i;
+
+    for(i=0; i<_NUM_BAUD_RATES; i++)
+    {
+        if(_CameraVerifyBaudRate(_sBaudRates[i].ulBaudRate))
+        {
+            break;
+        }
     }
 
-    // Resume updating frame
-    if(!VC0706SetFrameControl(VC0706_CURRENT_FRAME_CONTROL_RESUME))
+    return i;
+}
+
+static unsigned int _CameraSwitchBaudRate(unsigned int uiFrom,
+                                          unsigned int uiTo)
+{
+    // The camera acknowledges at the old rate before switching
+    if(!VC0706SetBaudRate(_sBaudRates[uiTo].usCameraBaud))
+    {
+        return _CameraVerifyBaudRate(_sBaudRates[uiFrom].ulBaudRate) ?
+               uiFrom : _NUM_BAUD_RATES;
+    }
+    osi_Sleep(CAMERA_BAUD_SETTLE_MS);
+
+    if(_CameraVerifyBaudRate(_sBaudRates[uiTo].ulBaudRate))
+    {
+        return uiTo;
+    }
+
+    // Fall back. The request is sent at the new rate, which the camera
+    // should be listening on even if the link is not clean enough to verify
+    VC0706SetBaudRate(_sBaudRates[uiFrom].usCameraBaud);
+    osi_Sleep(CAMERA_BAUD_SETTLE_MS);
+
+    if(_CameraVerifyBaudRate(_sBaudRates[uiFrom].ulBaudRate))
+    {
+        return uiFrom;
+    }
+
+    return _NUM_BAUD_RATES;
+}
+
+static tBoolean _CameraFrameBegin(unsigned int *puiFrameLen)
+{
+    tBoolean bStatus = 1;
+
+    *puiFrameLen = 0;
+
+    _sFrameTimes.ulCaptureStart = ClockGetMs();
+    _sFrameTimes.ulLengthRead = 0;
+    _sFrameTimes.ulReadDone = 0;
+
+    // Stop updating frame
+    switch(_ucCaptureMode)
+    {
+    case CAMERA_CAPTURE_NEXT_FRAME:
+        // Freeze the next-frame buffer, the sensor keeps the other one
+        _ucFrameType = VC0706_NEXT_FRAME;
+        bStatus = VC0706SetFrameControl(VC0706_NEXT_FRAME_CONTROL_STOP);
+        break;
+    case CAMERA_CAPTURE_STEP:
+        // A fresh frame was stepped in at the end of the last capture
+        _ucFrameType = VC0706_CURRENT_FRAME;
+        if(!_bFrameHeld)
+        {
+            bStatus = VC0706SetFrameControl(VC0706_CURRENT_FRAME_CONTROL_STOP);
+        }
+        _bFrameHeld = 0;
+        break;
+    default:
+        _ucFrameType = VC0706_CURRENT_FRAME;
+        bStatus = VC0706SetFrameControl(VC0706_CURRENT_FRAME_CONTROL_STOP);
+        break;
+    }
+
+    if(!bStatus)
+    {
+        return 0;
+    }
+
+    // Get size of frame
+    *puiFrameLen = VC0706GetFrameLength(_ucFrameType);
+    _sFrameTimes.ulLengthRead = ClockGetMs();
+
+    return *puiFrameLen != 0;
+}
+
+static tBoolean _CameraFrameEnd(unsigned int uiFrameLen)
+{
+    tBoolean bStatus;
+
+    _sFrameTimes.ulReadDone = ClockGetMs();
+
+    if(_ucCaptureMode == CAMERA_CAPTURE_STEP)
+    {
+        // Have the sensor capture the next frame and hold it, so it is
+        // ready as soon as the caller is done sending this one
+        bStatus = VC0706SetFrameControl(VC0706_CURRENT_FRAME_CONTROL_STEP);
+        _bFrameHeld = bStatus;
+    }
+    else
+    {
+        // Resume updating frame
+        bStatus = VC0706SetFrameControl(VC0706_CURRENT_FRAME_CONTROL_RESUME);
+    }
+
+    if(bStatus && (uiFrameLen > 0))
+    {
+        _sStats.uiFrames++;
+        _sStats.ulBytes += uiFrameLen;
+    }
+
+    return bStatus;
+}
+
+static unsigned int _CameraChunkLen(unsigned int uiBytesLeft,
+                                    unsigned int uiMaxLen)
+{
+    unsigned int uiChunkLen = _uiChunkSize;
+
+    // A chunk size of 0 reads as much as fits at once
+    if((uiChunkLen == 0) || (uiChunkLen > uiMaxLen))
     {
-        free(pucImageBuf);
-        *uiFrameLen = 0;
-        return NULL;
+        uiChunkLen = uiMaxLen;
     }
 
-    return pucImageBuf;
+    return uiBytesLeft>uiChunkLen ? uiChunkLen : uiBytesLeft;
 }
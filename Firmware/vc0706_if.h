@@ -11,7 +11,7 @@
 // December 5, 2015
 //
 // Modified:
-// December 19, 2015
+// October 17, 2026
 //
 //*****************************************************************************
 
@@ -33,16 +33,106 @@ extern "C"
 // Defines
 //*****************************************************************************
 #define CAMERA_DEFAULT_SERIAL_NUM           0
-#define CAMERA_DEFAULT_BAUD_RATE            VC0706_INTERFACE_UART_BAUD_38400
+#define CAMERA_DEFAULT_BAUD_RATE            115200  // Highest rate to try
+#define CAMERA_BAUD_SETTLE_MS               10
+#define CAMERA_BAUD_VERIFY_TRIES            3
+#define CAMERA_MOTION_CTRL_TRIES            3
 #define CAMERA_DEFAULT_IMAGE_SIZE           VC0706_IMAGE_SIZE_160_120
+#define CAMERA_DEFAULT_CHUNK_SIZE           512     // 0 for a whole frame
+#define CAMERA_DEFAULT_CTRL_MODE            VC0706_CONTROL_MODE_MCU
+#define CAMERA_STREAM_BUF_SIZE              1024    // Largest streamed chunk
+#define CAMERA_DEFAULT_OVERSIZE_POLICY      CAMERA_OVERSIZE_SKIP
+#define CAMERA_DEFAULT_CAPTURE_MODE         CAMERA_CAPTURE_STOP_RESUME
+#define CAMERA_DEFAULT_MOTION_HITS          1       // Alarms to count as motion
+#define CAMERA_DEFAULT_MOTION_WINDOW_MS     1000    // ...within this time
+
+
+// Frames larger than the snapshot buffer, see CameraSetOversizePolicy()
+#define CAMERA_OVERSIZE_SKIP                0   // Read nothing
+#define CAMERA_OVERSIZE_TRUNCATE            1   // Read what fits
+
+// CameraSnapshot() return values
+#define CAMERA_STATUS_OK                    0
+#define CAMERA_STATUS_TRUNCATED             1
+#define CAMERA_STATUS_SKIPPED               2
+#define CAMERA_STATUS_ERROR                 (-1)
+
+// Capture modes, see CameraSetCaptureMode()
+#define CAMERA_CAPTURE_STOP_RESUME          0   // Freeze, read, resume
+#define CAMERA_CAPTURE_STEP                 1   // Step a new frame in on read
+#define CAMERA_CAPTURE_NEXT_FRAME           2   // Read the next-frame buffer
+
+
+//*****************************************************************************
+// Types
+//*****************************************************************************
+// Called for every chunk read from the camera frame buffer, in order. The
+// chunk is only valid for the duration of the call. Returning 0 aborts the
+// snapshot.
+typedef tBoolean (*tCameraChunkHandler)(unsigned char *pucChunk,
+                                        unsigned int uiChunkLen,
+                                        unsigned int uiOffset,
+                                        unsigned int uiFrameLen,
+                                        void *pvArg);
+
+// Throughput of one chunk size, see CameraBenchmarkReadMode()
+typedef struct
+{
+    unsigned int uiChunkSize;
+    unsigned int uiFrames;
+    unsigned long ulBytes;
+    unsigned long ulElapsedMs;
+} tCameraBenchResult;
+
+// ClockGetMs() stamps of the last snapshot, see CameraGetFrameTimes()
+typedef struct
+{
+    unsigned long ulCaptureStart;   // Snapshot requested
+    unsigned long ulLengthRead;     // Frame frozen and its length known
+    unsigned long ulReadDone;       // Last byte read over the UART
+} tCameraFrameTimes;
+
+// Frames completed since the capture mode was last set
+typedef struct
+{
+    unsigned char ucCaptureMode;
+    unsigned int uiFrames;
+    unsigned int uiOversized;
+    unsigned long ulBytes;
+    unsigned long ulElapsedMs;
+} tCameraStats;
 
 
 //*****************************************************************************
 // Function Prototypes
 //*****************************************************************************
-extern tBoolean CameraInit(unsigned char ucSerialNum, unsigned short usBaudRate,
+extern tBoolean CameraInit(unsigned char ucSerialNum, unsigned long ulBaudRate,
                            unsigned char ucImageSize);
-extern unsigned char *CameraSnapshot(unsigned int *uiFrameLen);
+extern unsigned long CameraNegotiateBaudRate(unsigned long ulMaxBaudRate);
+extern unsigned long CameraGetBaudRate(void);
+extern long CameraSnapshot(unsigned char *pucBuf, unsigned int uiBufSize,
+                           unsigned int *puiFrameLen);
+extern void CameraSetOversizePolicy(unsigned char ucPolicy);
+extern tBoolean CameraSnapshotStream(tCameraChunkHandler pfnHandler,
+                                     void *pvArg, unsigned int *puiFrameLen);
+extern tBoolean CameraEnableMotion(tBoolean bEnable);
+extern void CameraSetMotionSensitivity(unsigned char ucHits,
+                                       unsigned long ulWindowMs);
+extern tBoolean CameraWaitMotion(unsigned long ulTimeoutMs);
+extern tBoolean CameraSetCaptureMode(unsigned char ucCaptureMode);
+extern tBoolean CameraSetQuality(unsigned char ucDownsize,
+                                 unsigned char ucCompression);
+extern void CameraGetStats(tCameraStats *psStats);
+extern void CameraGetFrameTimes(tCameraFrameTimes *psTimes);
+extern void CameraSetReadMode(unsigned int uiChunkSize,
+                              unsigned char ucCtrlMode);
+extern unsigned int CameraBenchmarkReadMode(const unsigned int *puiChunkSizes,
+                                            unsigned int uiNumSizes,
+                                            unsigned char ucCtrlMode,
+                                            unsigned int uiNumFrames,
+                                            unsigned char *pucBuf,
+                                            unsigned int uiBufSize,
+                                            tCameraBenchResult *psResults);
 
 
 //*****************************************************************************
@@ -0,0 +1,263 @@
+//*****************************************************************************
+//
+// vc0706_uart.c
+//
+// Interrupt driven UART for the VC0706 Serial Camera Module on the CC3200.
+//
+// Received bytes are moved from the UART FIFO into a ring buffer by the
+// interrupt handler, and a reader blocks on a sync object instead of polling,
+// so other tasks (e.g. the network) run while frame data arrives. Commands
+// are queued in a small TX ring that the interrupt handler feeds to the FIFO.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#include "hw_types.h"
+#include "hw_ints.h"
+#include "hw_memmap.h"
+#include "interrupt.h"
+#include "prcm.h"
+#include "rom_map.h"
+#include "uart.h"
+#include "osi.h"
+#include "vc0706.h"
+
+#include "vc0706_uart.h"
+
+
+//*****************************************************************************
+// Defines
+//*****************************************************************************
+#define _RX_MASK                (VC0706_UART_RX_BUF_SIZE - 1)
+#define _TX_MASK                (VC0706_UART_TX_BUF_SIZE - 1)
+#define _RX_COUNT()             ((_uiRxHead - _uiRxTail) & _RX_MASK)
+#define _TX_COUNT()             ((_uiTxHead - _uiTxTail) & _TX_MASK)
+
+
+//*****************************************************************************
+// Variables
+//*****************************************************************************
+static unsigned char _ucRxBuf[VC0706_UART_RX_BUF_SIZE];
+static volatile unsigned int _uiRxHead;     // Written by the ISR only
+static volatile unsigned int _uiRxTail;     // Written by the reader only
+static volatile unsigned int _uiRxWant;     // Bytes the reader waits for
+static volatile unsigned long _ulRxOverruns;
+static unsigned long _ulFlushIdleMs;
+static OsiSyncObj_t _RxSyncObj;
+
+static unsigned char _ucTxBuf[VC0706_UART_TX_BUF_SIZE];
+static volatile unsigned int _uiTxHead;     // Written by the writer only
+static volatile unsigned int _uiTxTail;     // Written with TX int disabled
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+static void _VC0706UartIntHandler(void);
+static void _VC0706UartTxFill(void);
+static unsigned int _VC0706UartRxCopy(unsigned char *pucBuf,
+                                      unsigned int uiLen);
+
+
+//*****************************************************************************
+// Function Implementations
+//*****************************************************************************
+void VC0706UartInit(unsigned long ulBaudRate)
+{
+    _uiRxHead = _uiRxTail = 0;
+    _uiTxHead = _uiTxTail = 0;
+    _uiRxWant = 0;
+    _ulRxOverruns = 0;
+
+    osi_SyncObjCreate(&_RxSyncObj);
+
+    VC0706UartSetBaudRate(ulBaudRate);
+
+    // Interrupt on half full RX FIFO, or when the line goes idle with bytes
+    // still in the FIFO
+    MAP_UARTFIFOLevelSet(VC0706, UART_FIFO_TX4_8, UART_FIFO_RX4_8);
+    MAP_UARTFIFOEnable(VC0706);
+
+    osi_InterruptRegister(VC0706_INT, _VC0706UartIntHandler,
+                          INT_PRIORITY_LVL_1);
+    MAP_UARTIntClear(VC0706, UART_INT_RX | UART_INT_RT | UART_INT_TX);
+    MAP_UARTIntEnable(VC0706, UART_INT_RX | UART_INT_RT);
+}
+
+void VC0706UartSetBaudRate(unsigned long ulBaudRate)
+{
+    MAP_UARTConfigSetExpClk(VC0706, MAP_PRCMPeripheralClockGet(VC0706_PERIPH),
+                            ulBaudRate,
+                            (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+                            UART_CONFIG_PAR_NONE));
+
+    // 10 bits per byte, plus a tick as osi_Sleep() may return early
+    _ulFlushIdleMs = (VC0706_UART_FLUSH_IDLE_BYTES * 10 * 1000) / ulBaudRate
+                     + 1;
+
+    MAP_UARTEnable(VC0706);
+}
+
+void VC0706UartWrite(const unsigned char *pucBuf, unsigned int uiLen)
+{
+    while(uiLen > 0)
+    {
+        // Wait for the ISR to make room
+        if(_TX_COUNT() == _TX_MASK)
+        {
+            osi_Sleep(1);
+            continue;
+        }
+
+        _ucTxBuf[_uiTxHead] = *pucBuf++;
+        _uiTxHead = (_uiTxHead + 1) & _TX_MASK;
+        uiLen--;
+
+        // Prime the FIFO; the TX interrupt only fires on a level change
+        MAP_UARTIntDisable(VC0706, UART_INT_TX);
+        _VC0706UartTxFill();
+        if(_TX_COUNT() > 0)
+        {
+            MAP_UARTIntEnable(VC0706, UART_INT_TX);
+        }
+    }
+}
+
+unsigned int VC0706UartRead(unsigned char *pucBuf, unsigned int uiLen,
+                            unsigned long ulTimeoutMs)
+{
+    unsigned int uiRead = 0;
+    unsigned int uiWant;
+    unsigned int uiHead;
+
+    // ulTimeoutMs is an idle time: a wait that ends with fewer bytes than
+    // asked for is only given up on if none came in at all, since at low
+    // baud rates half the ring takes longer to fill than the timeout
+    while(1)
+    {
+        uiRead += _VC0706UartRxCopy(pucBuf+uiRead, uiLen-uiRead);
+        if(uiRead == uiLen)
+        {
+            break;
+        }
+
+        // Ask the ISR to wake us once enough bytes are buffered
+        uiWant = uiLen - uiRead;
+        if(uiWant > VC0706_UART_RX_BUF_SIZE/2)
+        {
+            uiWant = VC0706_UART_RX_BUF_SIZE/2;
+        }
+
+        osi_SyncObjClear(&_RxSyncObj);
+        uiHead = _uiRxHead;
+        _uiRxWant = uiWant;
+
+        // Bytes may have landed between the copy and arming the wait
+        if(_RX_COUNT() >= uiWant)
+        {
+            _uiRxWant = 0;
+            continue;
+        }
+
+        if(osi_SyncObjWait(&_RxSyncObj, ulTimeoutMs) != OSI_OK)
+        {
+            _uiRxWant = 0;
+            if(_uiRxHead != uiHead)
+            {
+                continue;
+            }
+            uiRead += _VC0706UartRxCopy(pucBuf+uiRead, uiLen-uiRead);
+            break;
+        }
+    }
+
+    return uiRead;
+}
+
+void VC0706UartFlush(void)
+{
+    unsigned long ulWaitedMs = 0;
+    unsigned int uiHead;
+
+    // Drop bytes until the line has been quiet for a few byte times, so the
+    // tail of a late response cannot land after the flush. Bytes short of
+    // the FIFO level reach the ring on the receive timeout, well within it.
+    do
+    {
+        uiHead = _uiRxHead;
+        _uiRxTail = uiHead;
+        osi_Sleep(_ulFlushIdleMs);
+        ulWaitedMs += _ulFlushIdleMs;
+    }
+    while((_uiRxHead != uiHead) && (ulWaitedMs < VC0706_UART_FLUSH_MAX_MS));
+
+    _uiRxTail = _uiRxHead;
+}
+
+static void _VC0706UartIntHandler(void)
+{
+    unsigned long ulStatus;
+    unsigned int uiNext;
+
+    ulStatus = MAP_UARTIntStatus(VC0706, true);
+    MAP_UARTIntClear(VC0706, ulStatus);
+
+    // Drain RX FIFO into the ring
+    while(MAP_UARTCharsAvail(VC0706))
+    {
+        uiNext = (_uiRxHead + 1) & _RX_MASK;
+        if(uiNext == _uiRxTail)
+        {
+            MAP_UARTCharGetNonBlocking(VC0706);
+            _ulRxOverruns++;
+            continue;
+        }
+
+        _ucRxBuf[_uiRxHead] = MAP_UARTCharGetNonBlocking(VC0706);
+        _uiRxHead = uiNext;
+    }
+
+    if(_uiRxWant && (_RX_COUNT() >= _uiRxWant))
+    {
+        _uiRxWant = 0;
+        osi_SyncObjSignalFromISR(&_RxSyncObj);
+    }
+
+    // Refill TX FIFO, stop TX interrupts once the ring is empty
+    if(ulStatus & UART_INT_TX)
+    {
+        _VC0706UartTxFill();
+        if(_TX_COUNT() == 0)
+        {
+            MAP_UARTIntDisable(VC0706, UART_INT_TX);
+        }
+    }
+}
+
+static void _VC0706UartTxFill(void)
+{
+    while((_TX_COUNT() > 0) && MAP_UARTSpaceAvail(VC0706))
+    {
+        MAP_UARTCharPutNonBlocking(VC0706, _ucTxBuf[_uiTxTail]);
+        _uiTxTail = (_uiTxTail + 1) & _TX_MASK;
+    }
+}
+
+static unsigned int _VC0706UartRxCopy(unsigned char *pucBuf,
+                                      unsigned int uiLen)
+{
+    unsigned int uiCopied = 0;
+
+    while((uiCopied < uiLen) && (_RX_COUNT() > 0))
+    {
+        pucBuf[uiCopied++] = _ucRxBuf[_uiRxTail];
+        _uiRxTail = (_uiRxTail + 1) & _RX_MASK;
+    }
+
+    return uiCopied;
+}
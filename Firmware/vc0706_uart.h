@@ -0,0 +1,58 @@
+//*****************************************************************************
+//
+// vc0706_uart.h
+//
+// UART abstraction used by the VC0706 driver. The CC3200 implementation is
+// interrupt driven; other implementations can stand in for the camera link,
+// e.g. a fake UART when running the driver on a host.
+//
+// Created:
+// October 17, 2026
+//
+// Modified:
+// October 17, 2026
+//
+//*****************************************************************************
+
+#ifndef _VC0706_UART_H_
+#define _VC0706_UART_H_
+
+
+//*****************************************************************************
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+//*****************************************************************************
+// Defines
+//*****************************************************************************
+#define VC0706_UART_RX_BUF_SIZE             1024    // Must be a power of 2
+#define VC0706_UART_TX_BUF_SIZE             64      // Must be a power of 2
+#define VC0706_UART_FLUSH_IDLE_BYTES        8       // Quiet line to flush
+#define VC0706_UART_FLUSH_MAX_MS            100     // Even if it never is
+
+
+//*****************************************************************************
+// Function Prototypes
+//*****************************************************************************
+extern void VC0706UartInit(unsigned long ulBaudRate);
+extern void VC0706UartSetBaudRate(unsigned long ulBaudRate);
+extern void VC0706UartWrite(const unsigned char *pucBuf, unsigned int uiLen);
+extern unsigned int VC0706UartRead(unsigned char *pucBuf, unsigned int uiLen,
+                                   unsigned long ulTimeoutMs);
+extern void VC0706UartFlush(void);
+
+
+//*****************************************************************************
+// Mark the end of the C bindings section for C++ compilers.
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _VC0706_UART_H_ */
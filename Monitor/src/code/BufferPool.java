@@ -0,0 +1,36 @@
+package code;
+
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.function.Supplier;
+
+// Free list of buffers shared by the transfer workers, so receiving a frame
+// does not allocate once the pool has grown to the number of concurrent
+// transfers.
+public class BufferPool<T> {
+	private ConcurrentLinkedQueue<T> free = new ConcurrentLinkedQueue<T>();
+	private Supplier<T> factory;
+	private AtomicInteger created = new AtomicInteger();
+
+	public BufferPool(Supplier<T> factory) {
+		this.factory = factory;
+	}
+
+	public T acquire() {
+		T buffer = free.poll();
+		if (buffer == null) {
+			created.incrementAndGet();
+			buffer = factory.get();
+		}
+		return buffer;
+	}
+
+	public void release(T buffer) {
+		free.offer(buffer);
+	}
+
+	// Buffers allocated so far, in use or free
+	public int getCreated() {
+		return created.get();
+	}
+}
@@ -0,0 +1,99 @@
+package code;
+
+import java.util.concurrent.atomic.AtomicLong;
+
+// One camera as seen by the server: its own frame ring, a short history of
+// frames for event clips, a change detector and receive and latency
+// statistics, so a busy camera cannot push another one's frames out.
+public class Camera {
+	private static int RING_SIZE = 8;	//Frames kept per camera, older ones are dropped
+	private static long HISTORY_BYTES = 4L * 1024 * 1024;	//Kept for clips, about 10 s at 640x480
+	private static long WATCH_TIMEOUT = 3000;	//ms a camera counts as watched after its tile was last seen
+	private String id;
+	private FrameRing<Frame> frames = new FrameRing<Frame>(RING_SIZE, FrameRing.Policy.DROP_OLDEST);
+	private FrameHistory history = new FrameHistory(HISTORY_BYTES);
+	private ChangeDetector detector = new ChangeDetector();
+	private CameraStats stats = new CameraStats();
+	private AtomicLong bytesReceived = new AtomicLong();
+	private AtomicLong unchanged = new AtomicLong();
+	private volatile long lastReceivedAt;
+	private volatile long lastWatchedAt;
+
+	public Camera(String id) {
+		this.id = id;
+	}
+
+	// Tags the frame with its activity and keeps it in the history. Returns
+	// whether it was passed on to the ring, unchanged frames are thinned.
+	boolean offer(Frame frame) {
+		bytesReceived.addAndGet(frame.getData().length);
+		lastReceivedAt = frame.getReceivedAt();
+
+		float activity = detector.update(frame.getData(), frame.getData().length);
+		frame.setActivity(activity);
+		history.add(frame);
+		if (!detector.keep(activity, frame.getReceivedAt())) {
+			unchanged.incrementAndGet();
+			return false;
+		}
+		frames.offer(frame);
+		return true;
+	}
+
+	// Called by the display while the camera's tile can be seen, wakes a puller waiting for demand
+	void watched() {
+		lastWatchedAt = System.currentTimeMillis();
+		synchronized (this) {
+			notifyAll();
+		}
+	}
+
+	public boolean isWatched() {
+		return System.currentTimeMillis() - lastWatchedAt < WATCH_TIMEOUT;
+	}
+
+	// Waits up to timeoutMs for someone to watch the camera, returns whether someone does
+	synchronized boolean awaitWatched(long timeoutMs) throws InterruptedException {
+		long deadline = System.currentTimeMillis() + timeoutMs;
+		long left = timeoutMs;
+		while (!isWatched() && left > 0) {
+			wait(left);
+			left = deadline - System.currentTimeMillis();
+		}
+		return isWatched();
+	}
+
+	public String getId() {
+		return id;
+	}
+
+	public FrameRing<Frame> getFrames() {
+		return frames;
+	}
+
+	public FrameHistory getHistory() {
+		return history;
+	}
+
+	public CameraStats getStats() {
+		return stats;
+	}
+
+	public long getBytesReceived() {
+		return bytesReceived.get();
+	}
+
+	// Frames dropped because they did not differ from the one before
+	public long getUnchanged() {
+		return unchanged.get();
+	}
+
+	// System.currentTimeMillis() of the last frame, 0 if none yet
+	public long getLastReceivedAt() {
+		return lastReceivedAt;
+	}
+
+	public String toString() {
+		return id + ": " + frames + ", " + getUnchanged() + " unchanged, " + getBytesReceived() + " bytes";
+	}
+}
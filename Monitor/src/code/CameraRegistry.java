@@ -0,0 +1,89 @@
+package code;
+
+import java.net.InetAddress;
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.List;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.function.Consumer;
+
+// All cameras that have sent frames, keyed by camera id. Cameras are added
+// on their first frame. The display waits here for a frame from any camera.
+public class CameraRegistry {
+	static String DEFAULT_FILE_NAME = "writeToServer.jpg";	//Name every camera used before they were told apart
+	private ConcurrentHashMap<String, Camera> cameras = new ConcurrentHashMap<String, Camera>();
+	private List<Consumer<Camera>> listeners = new ArrayList<Consumer<Camera>>();
+	private boolean framePending;
+
+	// Id of the camera a frame came from: the requested file name without its
+	// extension, or the sender's address if there is no name or it is the
+	// name all cameras share
+	public static String cameraId(InetAddress addr, String fileName) {
+		if (fileName == null || fileName.isEmpty() || fileName.equalsIgnoreCase(DEFAULT_FILE_NAME)) {
+			return addr.getHostAddress();
+		}
+		int dot = fileName.lastIndexOf('.');
+		return dot > 0 ? fileName.substring(0, dot) : fileName;
+	}
+
+	// Name of a camera usable as a file or directory name
+	public static String fileName(String cameraId) {
+		return cameraId.replaceAll("[^A-Za-z0-9._-]", "_");
+	}
+
+	// Called with every camera when it sends its first frame, on the receiving thread
+	public synchronized void addListener(Consumer<Camera> listener) {
+		listeners.add(listener);
+	}
+
+	// Returns whether the frame was kept, see Camera.offer()
+	public boolean offer(String cameraId, Frame frame) {
+		Camera camera = cameras.get(cameraId);
+		if (camera == null) {
+			Camera added = new Camera(cameraId);
+			camera = cameras.putIfAbsent(cameraId, added);
+			if (camera == null) {
+				camera = added;
+				System.out.println("New camera " + cameraId + ".");
+				List<Consumer<Camera>> current;
+				synchronized (this) {
+					current = new ArrayList<Consumer<Camera>>(listeners);
+				}
+				for (Consumer<Camera> listener : current) {
+					listener.accept(camera);
+				}
+			}
+		}
+		if (!camera.offer(frame)) {
+			return false;
+		}
+
+		synchronized (this) {
+			framePending = true;
+			notifyAll();
+		}
+		return true;
+	}
+
+	// Waits up to timeoutMs for a frame from any camera since the last call,
+	// returns whether one arrived
+	public synchronized boolean awaitFrame(long timeoutMs) throws InterruptedException {
+		long deadline = System.currentTimeMillis() + timeoutMs;
+		long left = timeoutMs;
+		while (!framePending && left > 0) {
+			wait(left);
+			left = deadline - System.currentTimeMillis();
+		}
+		boolean arrived = framePending;
+		framePending = false;
+		return arrived;
+	}
+
+	public Camera get(String cameraId) {
+		return cameras.get(cameraId);
+	}
+
+	public Collection<Camera> getCameras() {
+		return cameras.values();
+	}
+}
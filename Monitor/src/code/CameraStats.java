@@ -0,0 +1,128 @@
+package code;
+
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+// Latency, loss and jitter of one camera's frames, from their FrameTiming.
+// Camera stages come from the camera clock and server stages from the
+// server clock; no stage spans both. Frames from cameras that send no
+// timestamps only count towards the server stages.
+public class CameraStats {
+	// Camera stages
+	public static final String CAMERA = "camera";	//Capture start to frame length read
+	public static final String UART = "uart";	//Frame length read to whole frame read
+	public static final String SEND = "send";	//Frame read to sent, known with the next frame
+	public static final String DEVICE = "device";	//Capture start to sent, known with the next frame
+	// Server stages
+	public static final String TRANSFER = "transfer";	//Request received to last block
+	public static final String QUEUE = "queue";	//Last block to decode start, waiting for the display
+	public static final String DECODE = "decode";
+	public static final String DISPLAY = "display";	//Decode end to shown
+	public static final String SERVER = "server";	//Request received to shown
+	static final String[] STAGES = {CAMERA, UART, SEND, DEVICE, TRANSFER, QUEUE, DECODE, DISPLAY, SERVER};
+	private static long RESTART_GAP = 1000;	//A sequence this far back is a camera restart, not a late frame
+	private Map<String, LatencyHistogram> stages = new LinkedHashMap<String, LatencyHistogram>();
+	private long frames;
+	private long lost;
+	private long late;
+	private long restarts;
+	private long nextSeq = -1;
+	private long lastSeq = -1;	//Of the previous frame, for the stages it completes
+	private long lastCaptureStart;
+	private long lastReadDone;
+	private long lastArrival;	//ns
+	private double jitter;	//ms, RFC 3550 estimator
+
+	public CameraStats() {
+		for (String stage : STAGES) {
+			stages.put(stage, new LatencyHistogram());
+		}
+	}
+
+	// A frame was received, after its last block
+	public synchronized void received(FrameTiming timing) {
+		frames++;
+		stage(TRANSFER).record(micros(FrameTiming.serverInterval(timing.requestReceived, timing.lastBlock)));
+		if (timing.seq < 0) {
+			return;
+		}
+
+		// Loss and order, from sequence gaps
+		if (nextSeq < 0 || timing.seq < nextSeq - RESTART_GAP) {
+			if (nextSeq >= 0) restarts++;
+			nextSeq = timing.seq + 1;
+			lastSeq = -1;
+		} else if (timing.seq >= nextSeq) {
+			lost += timing.seq - nextSeq;
+			nextSeq = timing.seq + 1;
+		} else {
+			late++;	//Counted as lost when it was skipped
+			if (lost > 0) lost--;
+			return;	//Its times say nothing about the frame before the current one
+		}
+
+		stage(CAMERA).record(deviceMicros(timing.captureStart, timing.lengthRead));
+		stage(UART).record(deviceMicros(timing.lengthRead, timing.readDone));
+
+		// The camera sends the previous frame's send time with this one
+		if (lastSeq >= 0 && lastSeq == timing.seq - 1) {
+			stage(SEND).record(deviceMicros(lastReadDone, timing.prevSent));
+			stage(DEVICE).record(deviceMicros(lastCaptureStart, timing.prevSent));
+		}
+
+		// Jitter of the arrival times against the capture times, RFC 3550 6.4.1
+		if (lastSeq >= 0 && timing.captureStart != 0 && lastCaptureStart != 0) {
+			double arrivalMs = (timing.lastBlock - lastArrival) / 1e6;
+			double captureMs = (int)(timing.captureStart - lastCaptureStart);	//Wraps with the camera clock
+			jitter += (Math.abs(arrivalMs - captureMs) - jitter) / 16;
+		}
+
+		lastSeq = timing.seq;
+		lastCaptureStart = timing.captureStart;
+		lastReadDone = timing.readDone;
+		lastArrival = timing.lastBlock;
+	}
+
+	// A frame was shown, frames dropped before display never get here
+	public void displayed(FrameTiming timing) {
+		stage(QUEUE).record(micros(FrameTiming.serverInterval(timing.lastBlock, timing.decodeStart)));
+		stage(DECODE).record(micros(FrameTiming.serverInterval(timing.decodeStart, timing.decodeEnd)));
+		stage(DISPLAY).record(micros(FrameTiming.serverInterval(timing.decodeEnd, timing.displayed)));
+		stage(SERVER).record(micros(FrameTiming.serverInterval(timing.requestReceived, timing.displayed)));
+	}
+
+	private static long micros(long nanos) {
+		return nanos < 0 ? -1 : nanos / 1000;
+	}
+
+	private static long deviceMicros(long fromMs, long toMs) {
+		long ms = FrameTiming.deviceInterval(fromMs, toMs);
+		return ms < 0 ? -1 : ms * 1000;
+	}
+
+	public LatencyHistogram stage(String name) {
+		return stages.get(name);
+	}
+
+	public synchronized long getFrames() {
+		return frames;
+	}
+
+	// Frames missing from the sequence, not counting those that turned up late
+	public synchronized long getLost() {
+		return lost;
+	}
+
+	public synchronized long getLate() {
+		return late;
+	}
+
+	public synchronized long getRestarts() {
+		return restarts;
+	}
+
+	// Interarrival jitter in ms
+	public synchronized double getJitter() {
+		return jitter;
+	}
+}
@@ -0,0 +1,41 @@
+package code;
+
+// Tells how much a camera's frame differs from its previous one without
+// decoding it, from the luma DC coefficients (see JpegDcReader): the activity
+// is the fraction of MCUs whose average brightness moved by more than
+// BLOCK_THRESHOLD. Unchanged frames are thinned to one per KEEP_INTERVAL, so
+// an idle camera costs almost no decode, storage or display work.
+public class ChangeDetector {
+	public static float UNKNOWN = -1f;	//No previous frame of the same size, or not a baseline JPEG
+	public static float EVENT_ACTIVITY = 0.25f;	//Activity that counts as an event, e.g. for clips
+	private static float CHANGE_ACTIVITY = 0.02f;	//Frames below this are unchanged
+	private static int BLOCK_THRESHOLD = 8 * 6;	//Dequantized DC is 8x the block mean, so 6 grey levels
+	private static long KEEP_INTERVAL = 5000;	//Unchanged frames still kept this often (ms)
+	private int[] previous;
+	private long lastKept;
+
+	// Activity of a frame against the previous one, 0 (still) to 1, or UNKNOWN
+	public synchronized float update(byte[] jpeg, int length) {
+		int[] dc = JpegDcReader.readLumaDc(jpeg, length);
+		int[] last = previous;
+		previous = dc;
+		if (dc == null || last == null || dc.length != last.length) {
+			return UNKNOWN;
+		}
+
+		int changed = 0;
+		for (int i = 0; i < dc.length; i++) {
+			if (Math.abs(dc[i] - last[i]) > BLOCK_THRESHOLD) changed++;
+		}
+		return (float)changed / dc.length;
+	}
+
+	// Whether a frame with this activity is passed on, or dropped as a repeat
+	public synchronized boolean keep(float activity, long now) {
+		if (activity == UNKNOWN || activity >= CHANGE_ACTIVITY || now - lastKept >= KEEP_INTERVAL) {
+			lastKept = now;
+			return true;
+		}
+		return false;
+	}
+}
@@ -0,0 +1,164 @@
+package code;
+
+import java.io.BufferedOutputStream;
+import java.io.DataOutputStream;
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.Executors;
+import java.util.concurrent.ScheduledExecutorService;
+import java.util.concurrent.TimeUnit;
+
+// Saves the frames around an event as one clip file per camera: the frames
+// still in the camera's history from preMs before the trigger, and the ones
+// received up to postMs after it. A trigger while a clip of the same camera
+// is being collected extends that clip instead of starting another one. A
+// clip that grows past MAX_CLIP_MS or MAX_CLIP_BYTES is written out and
+// continued in a new file, so a scene that stays busy keeps memory bounded.
+//
+// Clips go to clips/<camera>/<start time>-<reason>.clip, as records of
+// timestamp(8) length(4) JPEG(length), the same as recording segments.
+public class ClipRecorder {
+	public static String REASON_MANUAL = "manual";
+	public static String REASON_DETECTOR = "detector";
+	public static String REASON_CAMERA_MOTION = "motion";
+	private static long MAX_CLIP_MS = 60000;	//Per file, a longer event is split
+	private static long MAX_CLIP_BYTES = 8L * 1024 * 1024;	//Per file, held in memory until written
+	private File root;
+	private long preMs;
+	private long postMs;
+	private ConcurrentHashMap<String, Clip> active = new ConcurrentHashMap<String, Clip>();	//By camera id
+	private ScheduledExecutorService writer = Executors.newSingleThreadScheduledExecutor();
+
+	public ClipRecorder(File root, long preMs, long postMs) {
+		this.root = root;
+		this.preMs = preMs;
+		this.postMs = postMs;
+	}
+
+	// Starts or extends a clip of camera, may be called from any thread
+	public synchronized void trigger(Camera camera, String reason) {
+		long now = System.currentTimeMillis();
+		Clip clip = active.get(camera.getId());
+		if (clip != null) {
+			clip.end = Math.max(clip.end, now + postMs);
+			return;
+		}
+
+		clip = new Clip(camera.getId(), reason, now - preMs, now + postMs);
+		for (Frame frame : camera.getHistory().since(clip.start)) {
+			clip.add(frame);
+		}
+		active.put(camera.getId(), clip);
+		System.out.println("Clip of " + camera.getId() + " triggered (" + reason + ").");
+		scheduleFinish(clip, postMs);
+	}
+
+	// Called with every frame after it is added to the camera's history
+	void frameReceived(Camera camera, Frame frame) {
+		Clip clip = active.get(camera.getId());
+		if (clip == null) {
+			return;
+		}
+		synchronized (clip) {
+			// The trigger may already have taken this frame from the history
+			boolean taken = !clip.frames.isEmpty() && clip.frames.get(clip.frames.size() - 1) == frame;
+			if (clip.finished || taken || frame.getReceivedAt() > clip.end) {
+				return;
+			}
+			if (!clip.isFull(frame)) {
+				clip.add(frame);
+				return;
+			}
+		}
+		split(clip, frame);
+	}
+
+	// Writes a full clip now and goes on in a new one that starts with frame
+	private synchronized void split(Clip clip, Frame frame) {
+		if (active.get(clip.cameraId) != clip) {
+			return;	//Finished in the meantime
+		}
+
+		Clip next = new Clip(clip.cameraId, clip.reason, frame.getReceivedAt(), clip.end);
+		next.add(frame);
+		active.put(clip.cameraId, next);
+		writer.execute(() -> finish(clip));
+		scheduleFinish(next, Math.max(next.end - System.currentTimeMillis(), 0));
+	}
+
+	private void scheduleFinish(Clip clip, long delayMs) {
+		writer.schedule(() -> finish(clip), delayMs, TimeUnit.MILLISECONDS);
+	}
+
+	// Runs on the writer thread once the clip's end time has passed, or once it was split
+	private void finish(Clip clip) {
+		synchronized (this) {
+			if (active.get(clip.cameraId) == clip) {
+				long left = clip.end - System.currentTimeMillis();
+				if (left > 0) {
+					scheduleFinish(clip, left);	//Extended by a later trigger
+					return;
+				}
+				active.remove(clip.cameraId);
+			}
+		}
+
+		List<Frame> frames;
+		synchronized (clip) {
+			if (clip.finished) {
+				return;	//A split clip's original finish time came after it was written
+			}
+			clip.finished = true;
+			frames = clip.frames;
+		}
+
+		File dir = new File(root, CameraRegistry.fileName(clip.cameraId));
+		File file = new File(dir, String.format("%013d", clip.start) + "-" + clip.reason + ".clip");
+		if (!dir.isDirectory() && !dir.mkdirs()) {
+			System.out.println("Cannot create clip directory " + dir + ".");
+			return;
+		}
+		try (DataOutputStream out = new DataOutputStream(new BufferedOutputStream(new FileOutputStream(file)))) {
+			for (Frame frame : frames) {
+				out.writeLong(frame.getReceivedAt());
+				out.writeInt(frame.getData().length);
+				out.write(frame.getData());
+			}
+			System.out.println("Saved clip " + file + ": " + frames.size() + " frames.");
+		} catch (IOException e) {
+			System.out.println("Saving clip " + file + " failed: " + e.getMessage());
+		}
+	}
+
+	private static class Clip {
+		String cameraId;
+		String reason;
+		long start;
+		volatile long end;
+		List<Frame> frames = new ArrayList<Frame>();
+		long bytes;
+		boolean finished;
+
+		Clip(String cameraId, String reason, long start, long end) {
+			this.cameraId = cameraId;
+			this.reason = reason;
+			this.start = start;
+			this.end = end;
+		}
+
+		void add(Frame frame) {
+			frames.add(frame);
+			bytes += frame.getData().length;
+		}
+
+		// Whether frame belongs in the next file
+		boolean isFull(Frame frame) {
+			return !frames.isEmpty() && (bytes + frame.getData().length > MAX_CLIP_BYTES
+					|| frame.getReceivedAt() - start > MAX_CLIP_MS);
+		}
+	}
+}
@@ -0,0 +1,209 @@
+package code;
+
+import java.awt.Color;
+import java.awt.Graphics;
+import java.awt.Graphics2D;
+import java.awt.RenderingHints;
+import java.awt.image.BufferedImage;
+import java.io.ByteArrayInputStream;
+import java.io.IOException;
+import java.text.DateFormat;
+import java.text.SimpleDateFormat;
+import java.util.Date;
+import java.util.Iterator;
+
+import javax.imageio.ImageIO;
+import javax.imageio.ImageReadParam;
+import javax.imageio.ImageReader;
+import javax.imageio.stream.ImageInputStream;
+
+// A received frame, kept as the compressed JPEG it arrived as. It is only
+// decoded (and stamped with its receive time) when a consumer asks for the
+// image, so frames that are dropped before display never cost a decode.
+//
+// Decoded images are cached as a small pyramid: full size, 1/2 (preview) and
+// 1/4 (thumbnail). A consumer asks for the size it draws at and gets the
+// smallest level that covers it. A missing level is scaled down from a
+// larger one already decoded, or else decoded with source subsampling, so a
+// grid tile never holds a full size image.
+public class Frame {
+	public static final int FULL = 1;	//Pyramid levels, as subsampling factors
+	public static final int PREVIEW = 2;
+	public static final int THUMBNAIL = 4;
+	private static final int[] LEVELS = {THUMBNAIL, PREVIEW, FULL};	//Smallest first
+	private static float TIMESTAMP_FONT_SIZE = 15f;
+	private static float MIN_TIMESTAMP_FONT_SIZE = 8f;
+	private String source;
+	private long receivedAt;	//System.currentTimeMillis() at the end of the transfer
+	private byte[] data;
+	private FrameTiming timing;	//Null for frames read back from a recording
+	private volatile float activity = ChangeDetector.UNKNOWN;
+	private BufferedImage[] images = new BufferedImage[LEVELS.length];
+	private int width = -1;	//Full size, read from the JPEG header on the first decode
+	private int height = -1;
+
+	public Frame(String source, long receivedAt, byte[] data) {
+		this(source, receivedAt, data, null);
+	}
+
+	public Frame(String source, long receivedAt, byte[] data, FrameTiming timing) {
+		this.source = source;
+		this.receivedAt = receivedAt;
+		this.data = data;
+		this.timing = timing;
+	}
+
+	// Full size image with the timestamp drawn on it, null if the data is not an image
+	public BufferedImage getImage() throws IOException {
+		return getLevel(FULL);
+	}
+
+	// Smallest cached or decodable image at least width x height (or the full
+	// size image if that is smaller), null if the data is not an image
+	public synchronized BufferedImage getImage(int width, int height) throws IOException {
+		if (this.width < 0 && !readSize()) {
+			return null;
+		}
+
+		for (int level : LEVELS) {
+			if (this.width / level >= width && this.height / level >= height) {
+				return getLevel(level);
+			}
+		}
+		return getLevel(FULL);
+	}
+
+	private synchronized BufferedImage getLevel(int level) throws IOException {
+		int index = indexOf(level);
+		if (images[index] != null) {
+			return images[index];
+		}
+
+		// Scaling a larger level down is cheaper than decoding again
+		BufferedImage image = null;
+		for (int i = index + 1; i < LEVELS.length; i++) {
+			if (images[i] != null) {
+				image = scale(images[i], images[i].getWidth() * LEVELS[i] / level, images[i].getHeight() * LEVELS[i] / level);
+				break;
+			}
+		}
+		if (image == null) {
+			image = decode(level);
+			if (image == null) {
+				return null;
+			}
+			stamp(image, level);
+		}
+
+		images[index] = image;
+		return image;
+	}
+
+	private BufferedImage decode(int subsampling) throws IOException {
+		ImageInputStream in = ImageIO.createImageInputStream(new ByteArrayInputStream(data));
+		try {
+			Iterator<ImageReader> readers = ImageIO.getImageReaders(in);
+			if (!readers.hasNext()) {
+				return null;
+			}
+			ImageReader reader = readers.next();
+			try {
+				reader.setInput(in, true, true);
+				width = reader.getWidth(0);
+				height = reader.getHeight(0);
+
+				// The reader skips the pixels left out, no full size image is made
+				ImageReadParam param = reader.getDefaultReadParam();
+				param.setSourceSubsampling(subsampling, subsampling, 0, 0);
+				return reader.read(0, param);
+			} finally {
+				reader.dispose();
+			}
+		} finally {
+			in.close();
+		}
+	}
+
+	// Reads the full size from the JPEG header only, returns false if the data is not an image
+	private boolean readSize() throws IOException {
+		ImageInputStream in = ImageIO.createImageInputStream(new ByteArrayInputStream(data));
+		try {
+			Iterator<ImageReader> readers = ImageIO.getImageReaders(in);
+			if (!readers.hasNext()) {
+				return false;
+			}
+			ImageReader reader = readers.next();
+			try {
+				reader.setInput(in, true, true);
+				width = reader.getWidth(0);
+				height = reader.getHeight(0);
+				return true;
+			} finally {
+				reader.dispose();
+			}
+		} finally {
+			in.close();
+		}
+	}
+
+	private static BufferedImage scale(BufferedImage src, int width, int height) {
+		BufferedImage dst = new BufferedImage(Math.max(width, 1), Math.max(height, 1), BufferedImage.TYPE_INT_RGB);
+		Graphics2D g = dst.createGraphics();
+		g.setRenderingHint(RenderingHints.KEY_INTERPOLATION, RenderingHints.VALUE_INTERPOLATION_BILINEAR);
+		g.drawImage(src, 0, 0, dst.getWidth(), dst.getHeight(), null);
+		g.dispose();
+		return dst;
+	}
+
+	// Add time to the image, scaled with the level so it covers the same area
+	private void stamp(BufferedImage image, int level) {
+		DateFormat dateFormat = new SimpleDateFormat("yyyy/MM/dd HH:mm:ss");
+		Graphics g = image.getGraphics();
+		g.setFont(g.getFont().deriveFont(Math.max(TIMESTAMP_FONT_SIZE / level, MIN_TIMESTAMP_FONT_SIZE)));
+		g.setColor(Color.RED);
+		g.drawString(dateFormat.format(new Date(receivedAt)), 30 / level, 30 / level);
+		g.dispose();
+	}
+
+	private static int indexOf(int level) {
+		for (int i = 0; i < LEVELS.length; i++) {
+			if (LEVELS[i] == level) return i;
+		}
+		throw new IllegalArgumentException("Not a pyramid level: " + level);
+	}
+
+	// Drops the cached images, the frame can still be decoded again. Called once
+	// the display has moved on, so frames kept for history and clips hold only
+	// their compressed bytes.
+	public synchronized void releaseImages() {
+		for (int i = 0; i < images.length; i++) {
+			images[i] = null;
+		}
+	}
+
+	// Change against the camera's previous frame, see ChangeDetector
+	public float getActivity() {
+		return activity;
+	}
+
+	void setActivity(float activity) {
+		this.activity = activity;
+	}
+
+	public FrameTiming getTiming() {
+		return timing;
+	}
+
+	public String getSource() {
+		return source;
+	}
+
+	public long getReceivedAt() {
+		return receivedAt;
+	}
+
+	// Compressed JPEG bytes, not to be modified
+	public byte[] getData() {
+		return data;
+	}
+}
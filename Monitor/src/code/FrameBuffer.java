@@ -0,0 +1,49 @@
+package code;
+
+import java.io.DataInputStream;
+import java.io.IOException;
+import java.util.Arrays;
+
+// Growable buffer a frame is assembled in. Blocks are written straight to
+// the end of it. Buffers are pooled, so once received the frame is copied
+// exactly once, into the Frame that FrameSink hands on.
+public class FrameBuffer {
+	private byte[] data;
+	private int length;
+
+	public FrameBuffer(int capacity) {
+		data = new byte[capacity];
+	}
+
+	// Empties the buffer, making room for at least capacity bytes
+	public void reset(int capacity) {
+		if (capacity > data.length) {
+			data = new byte[capacity];
+		}
+		length = 0;
+	}
+
+	public void write(byte[] src, int offset, int len) {
+		if (length + len > data.length) {
+			data = Arrays.copyOf(data, Math.max(data.length * 2, length + len));
+		}
+		System.arraycopy(src, offset, data, length, len);
+		length += len;
+	}
+
+	// Replaces the contents with exactly len bytes read from in
+	public void readFrom(DataInputStream in, int len) throws IOException {
+		reset(len);
+		in.readFully(data, 0, len);
+		length = len;
+	}
+
+	// Backing array, only the first getLength() bytes are valid
+	public byte[] getData() {
+		return data;
+	}
+
+	public int getLength() {
+		return length;
+	}
+}
@@ -0,0 +1,150 @@
+package code;
+
+import java.awt.Component;
+import java.awt.Container;
+import java.awt.Dimension;
+import java.awt.Graphics;
+import java.awt.Graphics2D;
+import java.awt.GraphicsConfiguration;
+import java.awt.Rectangle;
+import java.awt.RenderingHints;
+import java.awt.event.ComponentAdapter;
+import java.awt.event.ComponentEvent;
+import java.awt.event.HierarchyBoundsListener;
+import java.awt.event.HierarchyEvent;
+import java.awt.image.BufferedImage;
+import java.awt.image.VolatileImage;
+
+import javax.swing.JComponent;
+
+// The one component the monitor draws frames on. A new frame only swaps the
+// image and asks for a repaint, which Swing coalesces, so there is no layout
+// pass or new component per frame. The frame is scaled once into a volatile
+// (video memory) image, and repaints of the same frame only blit that.
+// Whether the canvas can be seen, and its size, are kept up to date on the
+// event dispatch thread for the monitor timer, which decodes off it.
+public class FrameCanvas extends Component {
+
+	private static final long serialVersionUID = 1L;
+	private volatile BufferedImage image;
+	private BufferedImage rendered;	//Frame the back buffer holds, used on the paint thread only
+	private VolatileImage buffer;
+	private volatile boolean onScreen;	//Written on the event dispatch thread, see updateOnScreen()
+	private volatile int tileWidth;
+	private volatile int tileHeight;
+
+	public FrameCanvas(BufferedImage image) {
+		this.image = image;
+
+		// Resized or moved in its tile, shown or hidden, or scrolled with the panel
+		addComponentListener(new ComponentAdapter() {
+			public void componentResized(ComponentEvent e) {
+				updateOnScreen();
+			}
+
+			public void componentMoved(ComponentEvent e) {
+				updateOnScreen();
+			}
+
+			public void componentShown(ComponentEvent e) {
+				updateOnScreen();
+			}
+
+			public void componentHidden(ComponentEvent e) {
+				updateOnScreen();
+			}
+		});
+		addHierarchyListener(e -> {
+			if ((e.getChangeFlags() & HierarchyEvent.SHOWING_CHANGED) != 0) updateOnScreen();
+		});
+		addHierarchyBoundsListener(new HierarchyBoundsListener() {
+			public void ancestorMoved(HierarchyEvent e) {
+				updateOnScreen();
+			}
+
+			public void ancestorResized(HierarchyEvent e) {
+				updateOnScreen();
+			}
+		});
+	}
+
+	// Whether any of the canvas can be seen, may be called from any thread
+	public boolean isOnScreen() {
+		return onScreen;
+	}
+
+	// Size to decode frames at, may be called from any thread
+	public int getTileWidth() {
+		return tileWidth;
+	}
+
+	public int getTileHeight() {
+		return tileHeight;
+	}
+
+	// Runs on the event dispatch thread
+	private void updateOnScreen() {
+		boolean visible = isShowing() && getWidth() > 0 && getHeight() > 0;
+		Container parent = getParent();
+		if (visible && parent instanceof JComponent) {
+			Rectangle parentVisible = ((JComponent)parent).getVisibleRect();
+			visible = parentVisible.intersects(getBounds());
+		}
+		tileWidth = getWidth();
+		tileHeight = getHeight();
+		onScreen = visible;
+	}
+
+	// May be called from any thread
+	public void showImage(BufferedImage image) {
+		this.image = image;
+		repaint();
+	}
+
+	public void paint(Graphics g) {
+		BufferedImage img = image;
+		if (img == null) {
+			return;
+		}
+
+		int width = getWidth();
+		int height = getHeight();
+		GraphicsConfiguration gc = getGraphicsConfiguration();
+		if (gc == null || width <= 0 || height <= 0) {
+			g.drawImage(img, 0, 0, null);
+			return;
+		}
+
+		do {
+			if (buffer == null || buffer.getWidth() != width || buffer.getHeight() != height
+					|| buffer.validate(gc) == VolatileImage.IMAGE_INCOMPATIBLE) {
+				if (buffer != null) buffer.flush();
+				buffer = createVolatileImage(width, height);
+				rendered = null;
+			} else if (buffer.contentsLost()) {
+				rendered = null;
+			}
+
+			// Scale a new frame into video memory once
+			if (rendered != img) {
+				Graphics2D bg = buffer.createGraphics();
+				bg.setRenderingHint(RenderingHints.KEY_INTERPOLATION, RenderingHints.VALUE_INTERPOLATION_BILINEAR);
+				bg.drawImage(img, 0, 0, width, height, null);
+				bg.dispose();
+				rendered = img;
+			}
+
+			g.drawImage(buffer, 0, 0, null);
+		} while (buffer.contentsLost());
+	}
+
+	// Nothing to clear, the frame covers the whole component
+	public void update(Graphics g) {
+		paint(g);
+	}
+
+	public Dimension getPreferredSize() {
+		return new Dimension(160, 120);
+	}
+
+}
@@ -0,0 +1,45 @@
+package code;
+
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.List;
+
+// The last few seconds of a camera's compressed frames, bounded in bytes
+// rather than frames so memory use does not depend on the resolution. The
+// oldest frames are dropped as new ones come in. Only the frame on display
+// holds decoded images, the monitor releases them when it moves on, so the
+// compressed bytes are what the bound has to count.
+public class FrameHistory {
+	private ArrayDeque<Frame> frames = new ArrayDeque<Frame>();
+	private long maxBytes;
+	private long bytes;
+
+	public FrameHistory(long maxBytes) {
+		this.maxBytes = maxBytes;
+	}
+
+	public synchronized void add(Frame frame) {
+		frames.addLast(frame);
+		bytes += frame.getData().length;
+		while (bytes > maxBytes && frames.size() > 1) {
+			bytes -= frames.removeFirst().getData().length;
+		}
+	}
+
+	// Frames received at or after from, oldest first
+	public synchronized List<Frame> since(long from) {
+		List<Frame> result = new ArrayList<Frame>();
+		for (Frame frame : frames) {
+			if (frame.getReceivedAt() >= from) result.add(frame);
+		}
+		return result;
+	}
+
+	public synchronized long getBytes() {
+		return bytes;
+	}
+
+	public synchronized int size() {
+		return frames.size();
+	}
+}
@@ -0,0 +1,241 @@
+package code;
+
+import java.io.IOException;
+import java.net.DatagramPacket;
+import java.net.DatagramSocket;
+import java.net.InetAddress;
+import java.net.SocketTimeoutException;
+import java.net.UnknownHostException;
+import java.nio.ByteBuffer;
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+// Pulls frames from one camera in pull mode (CAPTURE_PULL in the firmware).
+// The camera captures a frame only when it gets a read request on its TFTP
+// port, so frames are asked for one after the other while the camera's tile
+// is watched and once every IDLE_INTERVAL while it is not, which keeps the
+// history and recordings going at next to no load. Block size, window size
+// and the camera's timestamps are negotiated as options, the way a camera
+// in push mode offers them with its write requests.
+public class FramePuller extends Thread {
+	static int CAMERA_PORT = 69;
+	private static int TIMEOUT = 2000;	//Maximum time to wait for the camera before re-sending (ms)
+	private static int FIRST_TIMEOUT = 10000;	//For the first answer, which comes after the capture (ms)
+	private static int IDLE_INTERVAL = 10000;	//Between frames while nobody watches the camera (ms)
+	private static int RETRY_INTERVAL = 1000;	//After a failed pull (ms)
+	private static int BLKSIZE = 1428;	//Largest the camera accepts, TFTP_STREAM_BLOCK_SIZE_MAX
+	private static int WINDOWSIZE = 4;	//TFTP_STREAM_WINDOW_SIZE_MAX
+	private static int MAX_PREALLOCATE = 1024 * 1024;	//Largest tsize that is trusted for preallocation
+	private InetAddress addr;
+	private int port = CAMERA_PORT;
+	private String fileName = CameraRegistry.DEFAULT_FILE_NAME;
+	private String cameraId;
+	private boolean verbose = false;
+	private byte[] receiveBuffer = new byte[TFTP.OP_CODE_SIZE + TFTP.BLOCK_NUMBER_SIZE + TFTP.MAX_BLKSIZE + 1];
+
+	// spec is [name@]host[:port]. Frames are filed under the name as if the camera
+	// had written name.jpg, or under the host without one.
+	public FramePuller(String spec) throws UnknownHostException {
+		String host = spec;
+		int at = host.indexOf('@');
+		if (at >= 0) {
+			fileName = host.substring(0, at) + ".jpg";
+			host = host.substring(at + 1);
+		}
+		int colon = host.lastIndexOf(':');
+		if (colon >= 0) {
+			port = Integer.parseInt(host.substring(colon + 1));
+			host = host.substring(0, colon);
+			if (!TFTP.isValidPort(port)) throw new IllegalArgumentException("bad port " + port);
+		}
+		addr = InetAddress.getByName(host);
+		cameraId = CameraRegistry.cameraId(addr, fileName);
+	}
+
+	public String getCameraId() {
+		return cameraId;
+	}
+
+	public void run() {
+		System.out.println("Pulling frames from " + cameraId + " at " + addr.getHostAddress() + ":" + port + ".");
+
+		while (true) {
+			try {
+				if (!pull()) {
+					Thread.sleep(RETRY_INTERVAL);
+					continue;
+				}
+
+				// Straight on while watched, the camera's own frame time sets the pace
+				Camera camera = Start.getCameras().get(cameraId);
+				if (camera != null) {
+					camera.awaitWatched(IDLE_INTERVAL);
+				}
+			} catch (InterruptedException e) {
+				return;
+			}
+		}
+	}
+
+	// Reads one frame and delivers it, returns whether that worked
+	private boolean pull() {
+		DatagramSocket socket = null;
+		FrameBuffer fileBytes = FrameSink.frameBuffers.acquire();
+		long startTime = System.nanoTime();
+
+		try {
+			socket = new DatagramSocket();
+			socket.setSoTimeout(FIRST_TIMEOUT);
+
+			FrameTiming timing = new FrameTiming(startTime);	//Made as the RRQ is sent, so transfer includes the capture
+			int[] negotiated = new int[2];
+			if (!receiveFile(socket, fileBytes, timing, negotiated)) {
+				return false;
+			}
+			timing.lastBlock = System.nanoTime();
+
+			if (verbose) {
+				long elapsedMs = Math.max((System.nanoTime() - startTime) / 1000000, 1);
+				System.out.println(cameraId + ": " + fileBytes.getLength() + " bytes in " + elapsedMs + " ms, blksize "
+						+ negotiated[0] + ", windowsize " + negotiated[1]);
+			}
+			FrameSink.deliver(cameraId, fileBytes, timing, verbose);
+			return true;
+		} catch (IOException e) {
+			System.out.println("Pulling from " + cameraId + " failed: " + e.getMessage());
+			return false;
+		} finally {
+			FrameSink.frameBuffers.release(fileBytes);
+			if (socket != null) {
+				socket.close();
+			}
+		}
+	}
+
+	// Sends the RRQ and receives the DATA blocks, a window of windowsize blocks per ACK.
+	// negotiated gets the block and window size. Returns true once the last block was acknowledged.
+	private boolean receiveFile(DatagramSocket socket, FrameBuffer fileBytes, FrameTiming timing, int[] negotiated) throws IOException {
+		String[] errorMessage = new String[1];
+		int blockSize = TFTP.MAX_DATA_SIZE;
+		int windowSize = 1;
+		int TID = -1;
+		int currentBlockNumber = 1;
+		int windowCount = 0;
+
+		Map<String, String> options = new LinkedHashMap<String, String>();
+		options.put(TFTP.OPTION_BLKSIZE, Integer.toString(BLKSIZE));
+		options.put(TFTP.OPTION_TSIZE, "0");
+		options.put(TFTP.OPTION_WINDOWSIZE, Integer.toString(WINDOWSIZE));
+		FrameTiming.addRequestOptions(options);
+
+		fileBytes.reset(FrameSink.DEFAULT_FILE_SIZE);
+
+		DatagramPacket receivePacket = new DatagramPacket(receiveBuffer, receiveBuffer.length);
+		ByteBuffer receiveView = ByteBuffer.wrap(receiveBuffer);
+		DatagramPacket blockAckPacket = null;
+
+		// Re-sent on a timeout until something newer was sent
+		DatagramPacket lastSent = TFTP.formRQPacket(addr, port, new Request(Request.Type.READ, fileName, TFTP.MODE_OCTET, options));
+		socket.send(lastSent);
+
+		boolean transferComplete = false;
+
+		do {
+			receivePacket.setLength(receiveBuffer.length);
+
+			for (int i = 0; i < TFTPServer.RESEND_LIMIT + 1; i++) {
+				try {
+					socket.receive(receivePacket);
+					break;
+				} catch (SocketTimeoutException e) {
+					if (i == TFTPServer.RESEND_LIMIT) {
+						System.out.println("No response from " + cameraId + " after " + TFTPServer.RESEND_LIMIT + " attempts.");
+						return false;
+					}
+					socket.send(lastSent);
+				}
+			}
+
+			// The camera answers from a port of its own (its TID), anything else is ignored
+			if (!receivePacket.getAddress().equals(addr) || (TID >= 0 && receivePacket.getPort() != TID)) {
+				continue;
+			}
+			if (TID < 0) {
+				TID = receivePacket.getPort();
+				blockAckPacket = TFTP.formACKPacket(addr, TID, 0);
+				socket.setSoTimeout(TIMEOUT);
+			}
+
+			receiveView.clear();
+			receiveView.limit(receivePacket.getLength());
+			int opCode = TFTP.getOpCode(receiveView);
+
+			// Options are only acknowledged before the first block, with ACK 0
+			if (opCode == TFTP.OACK_OP_CODE && currentBlockNumber == 1) {
+				Map<String, String> accepted = TFTP.parseOACK(receivePacket);
+				try {
+					if (accepted.containsKey(TFTP.OPTION_BLKSIZE)) blockSize = Integer.parseInt(accepted.get(TFTP.OPTION_BLKSIZE));
+					if (accepted.containsKey(TFTP.OPTION_WINDOWSIZE)) windowSize = Integer.parseInt(accepted.get(TFTP.OPTION_WINDOWSIZE));
+					if (accepted.containsKey(TFTP.OPTION_TSIZE)) {
+						int transferSize = Integer.parseInt(accepted.get(TFTP.OPTION_TSIZE));
+						if (transferSize >= 0 && transferSize <= MAX_PREALLOCATE) fileBytes.reset(transferSize);
+					}
+				} catch (NumberFormatException e) {
+					socket.send(TFTP.formERRORPacket(addr, TID, TFTP.ERROR_CODE_OPTION_NEGOTIATION, "Bad option value."));
+					return false;
+				}
+				if (blockSize < TFTP.MIN_BLKSIZE || blockSize > BLKSIZE || windowSize < 1 || windowSize > WINDOWSIZE) {
+					socket.send(TFTP.formERRORPacket(addr, TID, TFTP.ERROR_CODE_OPTION_NEGOTIATION, "Options larger than requested."));
+					return false;
+				}
+				timing.setFromOptions(accepted);
+
+				lastSent = blockAckPacket;
+				if (verbose) System.out.println("OACK " + accepted + " from " + cameraId + ", sending ACK 0.");
+				socket.send(lastSent);
+				continue;
+			}
+
+			int lastWindowBlockNumber = (currentBlockNumber + windowSize - 1) % (TFTP.MAX_BLOCK_NUMBER + 1);
+			if (!TFTP.verifyDataPacket(receiveView, lastWindowBlockNumber, blockSize, errorMessage)) {
+				TFTP.shrinkData(receivePacket);
+				if (TFTP.verifyErrorPacket(receivePacket, new String[1])) {
+					System.out.println(cameraId + " refused the read: " + TFTP.getErrorMessage(receivePacket));
+				} else {
+					socket.send(TFTP.formERRORPacket(addr, TID, TFTP.ERROR_CODE_ILLEGAL_TFTP_OPERATION, errorMessage[0]));
+					System.out.println("Bad packet from " + cameraId + ": " + errorMessage[0]);
+				}
+				return false;
+			}
+
+			if (TFTP.getBlockNumber(receiveView) == currentBlockNumber) {
+				int dataLength = receivePacket.getLength() - TFTP.OP_CODE_SIZE - TFTP.BLOCK_NUMBER_SIZE;
+				fileBytes.write(receiveBuffer, TFTP.OP_CODE_SIZE + TFTP.BLOCK_NUMBER_SIZE, dataLength);
+				if (dataLength < blockSize) {
+					transferComplete = true;
+				}
+
+				// One ACK per window, and for the last block
+				windowCount++;
+				if (windowCount == windowSize || transferComplete) {
+					lastSent = blockAckPacket;
+					TFTP.setBlockNumber(lastSent, currentBlockNumber);
+					socket.send(lastSent);
+					windowCount = 0;
+				}
+
+				currentBlockNumber = (currentBlockNumber + 1) % (TFTP.MAX_BLOCK_NUMBER + 1);
+			} else {
+				// A block of the window was lost, have the camera go on after the last one in order
+				lastSent = blockAckPacket;
+				TFTP.setBlockNumber(lastSent, (currentBlockNumber + TFTP.MAX_BLOCK_NUMBER) % (TFTP.MAX_BLOCK_NUMBER + 1));
+				socket.send(lastSent);
+				windowCount = 0;
+			}
+		} while (!transferComplete);
+
+		negotiated[0] = blockSize;
+		negotiated[1] = windowSize;
+		return true;
+	}
+}
@@ -0,0 +1,114 @@
+package code;
+
+import java.util.concurrent.atomic.AtomicLong;
+
+// Bounded buffer of frames between the receiving threads and the monitor.
+// Producers never block: once the ring is full the oldest frame is dropped
+// (DROP_OLDEST), or only the newest frame is ever kept (LATEST_ONLY), so
+// memory stays flat however far the display falls behind the cameras. A
+// consumer can wait for frames instead of polling.
+public class FrameRing<T> {
+	public enum Policy { DROP_OLDEST, LATEST_ONLY }
+
+	private Object[] slots;
+	private int head;	//Next frame to consume
+	private int count;
+	private Policy policy;
+	private AtomicLong enqueued = new AtomicLong();
+	private AtomicLong dropped = new AtomicLong();
+	private AtomicLong consumed = new AtomicLong();
+
+	public FrameRing(int capacity, Policy policy) {
+		if (capacity < 1) {
+			throw new IllegalArgumentException("Capacity must be at least 1: " + capacity);
+		}
+		this.policy = policy;
+		slots = new Object[policy == Policy.LATEST_ONLY ? 1 : capacity];
+	}
+
+	// Adds a frame, dropping the oldest one if the ring is full
+	public synchronized void offer(T frame) {
+		if (count == slots.length) {
+			slots[head] = null;
+			head = (head + 1) % slots.length;
+			count--;
+			dropped.incrementAndGet();
+		}
+		slots[(head + count) % slots.length] = frame;
+		count++;
+		enqueued.incrementAndGet();
+		notifyAll();
+	}
+
+	// Waits up to timeoutMs for a frame, returns whether one is buffered
+	public synchronized boolean awaitFrame(long timeoutMs) throws InterruptedException {
+		long deadline = System.currentTimeMillis() + timeoutMs;
+		long left = timeoutMs;
+		while (count == 0 && left > 0) {
+			wait(left);
+			left = deadline - System.currentTimeMillis();
+		}
+		return count > 0;
+	}
+
+	// Oldest frame in the ring, or null if it is empty
+	@SuppressWarnings("unchecked")
+	public synchronized T poll() {
+		if (count == 0) {
+			return null;
+		}
+		T frame = (T)slots[head];
+		slots[head] = null;
+		head = (head + 1) % slots.length;
+		count--;
+		consumed.incrementAndGet();
+		return frame;
+	}
+
+	// Newest frame in the ring, or null if it is empty. Older frames are
+	// dropped, a consumer that is behind shows the latest one only.
+	@SuppressWarnings("unchecked")
+	public synchronized T pollLatest() {
+		if (count == 0) {
+			return null;
+		}
+		int last = (head + count - 1) % slots.length;
+		T frame = (T)slots[last];
+		for (int i = 0; i < count; i++) {
+			slots[(head + i) % slots.length] = null;
+		}
+		dropped.addAndGet(count - 1);
+		head = 0;
+		count = 0;
+		consumed.incrementAndGet();
+		return frame;
+	}
+
+	public synchronized int size() {
+		return count;
+	}
+
+	public int getCapacity() {
+		return slots.length;
+	}
+
+	public Policy getPolicy() {
+		return policy;
+	}
+
+	public long getEnqueued() {
+		return enqueued.get();
+	}
+
+	public long getDropped() {
+		return dropped.get();
+	}
+
+	public long getConsumed() {
+		return consumed.get();
+	}
+
+	public String toString() {
+		return "enqueued " + getEnqueued() + ", dropped " + getDropped() + ", consumed " + getConsumed() + ", buffered " + size() + "/" + getCapacity();
+	}
+}
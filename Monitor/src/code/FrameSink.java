@@ -0,0 +1,51 @@
+package code;
+
+import java.io.IOException;
+import java.util.Arrays;
+
+// Where received frames end up, whichever transport brought them. Frames are
+// assembled in buffers from a pool shared by all transports, and handed on
+// (and recorded) still compressed; decoding is left to whoever displays them.
+// Frames that did not change from the camera's previous one are neither
+// displayed nor recorded. Every frame counts towards its camera's stats.
+public class FrameSink {
+	static int DEFAULT_FILE_SIZE = 20 * 1024;	//Frame buffer size when the sender gives no length up front
+	static BufferPool<FrameBuffer> frameBuffers = new BufferPool<FrameBuffer>(() -> new FrameBuffer(DEFAULT_FILE_SIZE));
+
+	// Adds a received frame to the ring of the camera it came from, see CameraRegistry.cameraId().
+	// The bytes are copied out, the buffer goes back to the pool afterwards.
+	public static void deliver(String cameraId, FrameBuffer frame, FrameTiming timing, boolean verbose) {
+		byte[] data = Arrays.copyOf(frame.getData(), frame.getLength());
+		Frame received = new Frame(cameraId, System.currentTimeMillis(), data, timing);
+		boolean kept = Start.getCameras().offer(cameraId, received);
+
+		Camera camera = Start.getCameras().get(cameraId);
+		camera.getStats().received(timing);
+
+		// Clips get every frame, and start on a large change or when the camera saw motion
+		ClipRecorder clips = Start.getClips();
+		if (clips != null) {
+			if (received.getActivity() >= ChangeDetector.EVENT_ACTIVITY) {
+				clips.trigger(camera, ClipRecorder.REASON_DETECTOR);
+			}
+			if (timing.isMotion()) {
+				clips.trigger(camera, ClipRecorder.REASON_CAMERA_MOTION);
+			}
+			clips.frameReceived(camera, received);
+		}
+		if (!kept) {
+			if (verbose) System.out.print("Dropped unchanged frame from " + cameraId + "\n");
+			return;
+		}
+
+		RecordingStore recorder = Start.getRecorder();
+		if (recorder != null) {
+			try {
+				recorder.append(cameraId, received);
+			} catch (IOException e) {
+				System.out.println("Recording " + cameraId + " failed: " + e.getMessage());
+			}
+		}
+		if (verbose) System.out.print("Added one frame from " + cameraId + " to list!\n");
+	}
+}
@@ -0,0 +1,147 @@
+package code;
+
+import java.io.BufferedInputStream;
+import java.io.DataInputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.net.ServerSocket;
+import java.net.Socket;
+import java.net.SocketTimeoutException;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.SynchronousQueue;
+import java.util.concurrent.ThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
+
+// Receives frames over long-lived TCP connections, one per camera, as an
+// alternative to a TFTP session per frame. Every frame is preceded by a
+// header (big endian):
+//   'V' 'S' version header_length sequence(4) frame_length(4)
+// followed from version 2 by the camera's timestamps (ms since boot):
+//   capture_start(4) length_read(4) read_done(4) prev_sent(4) flags(1)
+// Header bytes past the known fields are skipped, so later versions can
+// append fields. A connection is dropped on a bad header, the camera
+// reconnects for its next frame.
+public class FrameStreamServer extends Thread {
+	static int PORT = 6066;
+	static byte MAGIC_0 = 'V';
+	static byte MAGIC_1 = 'S';
+	static int HEADER_SIZE = 12;
+	static int TIMED_HEADER_SIZE = 29;	//Version 2, with timestamps
+	private static int MAX_FRAME_SIZE = 1024 * 1024;	//Larger lengths are taken as a corrupt stream
+	private static int MAX_CONNECTIONS = 64;	//Cameras streaming at the same time, one thread each
+	private static int IDLE_TIMEOUT = 60000;	//Connections without a frame for this long are closed (ms)
+	private ServerSocket serverSocket;
+	private boolean verbose = false;
+	private ThreadPoolExecutor workers;
+
+	public FrameStreamServer() throws IOException {
+		try {
+			serverSocket = new ServerSocket(PORT);
+		} catch(Exception e) {
+			e.printStackTrace();
+			System.exit(1);
+		}
+
+		// No queue, a connection waiting for a worker would stall its camera
+		workers = new ThreadPoolExecutor(0, MAX_CONNECTIONS,
+				60, TimeUnit.SECONDS,
+				new SynchronousQueue<Runnable>());
+	}
+
+	public void run() {
+		System.out.println("Stream server started on port " + PORT + ".");
+
+		while (true) {
+			Socket client;
+			try {
+				client = serverSocket.accept();
+			} catch (IOException e) {
+				e.printStackTrace();
+				continue;
+			}
+
+			try {
+				workers.execute(() -> serve(client));
+			} catch (RejectedExecutionException e) {
+				System.out.println("Too many streams, refusing " + client.getRemoteSocketAddress() + ".");
+				close(client);
+			}
+		}
+	}
+
+	private void serve(Socket client) {
+		String source = client.getInetAddress().getHostAddress();	//Camera id, the stream carries no name
+		FrameBuffer frame = FrameSink.frameBuffers.acquire();
+		long frames = 0;
+
+		if (verbose) System.out.println("Stream from " + source + " opened.");
+		try {
+			client.setSoTimeout(IDLE_TIMEOUT);
+			client.setTcpNoDelay(true);
+			DataInputStream in = new DataInputStream(new BufferedInputStream(client.getInputStream()));
+
+			while (true) {
+				// Header
+				byte magic0;
+				try {
+					magic0 = in.readByte();
+				} catch (EOFException e) {
+					break;	//Closed between frames
+				}
+				byte magic1 = in.readByte();
+				int version = in.readUnsignedByte();
+				int headerLength = in.readUnsignedByte();
+				FrameTiming timing = new FrameTiming(System.nanoTime());
+				int sequence = in.readInt();
+				int frameLength = in.readInt();
+				if (magic0 != MAGIC_0 || magic1 != MAGIC_1 || headerLength < HEADER_SIZE) {
+					System.out.println("Bad stream header from " + source + ", closing.");
+					break;
+				}
+				if (frameLength < 0 || frameLength > MAX_FRAME_SIZE) {
+					System.out.println("Bad frame length " + frameLength + " from " + source + ", closing.");
+					break;
+				}
+				timing.seq = sequence & 0xFFFFFFFFL;
+				int headerRead = HEADER_SIZE;
+				if (headerLength >= TIMED_HEADER_SIZE) {
+					timing.captureStart = in.readInt() & 0xFFFFFFFFL;
+					timing.lengthRead = in.readInt() & 0xFFFFFFFFL;
+					timing.readDone = in.readInt() & 0xFFFFFFFFL;
+					timing.prevSent = in.readInt() & 0xFFFFFFFFL;
+					timing.flags = in.readUnsignedByte();
+					headerRead = TIMED_HEADER_SIZE;
+				}
+				in.skipBytes(headerLength - headerRead);
+
+				// Frame
+				frame.readFrom(in, frameLength);
+				timing.lastBlock = System.nanoTime();
+				frames++;
+				if (verbose) System.out.println("Frame " + sequence + " (version " + version + ") from " + source + ": " + frameLength + " bytes.");
+
+				FrameSink.deliver(source, frame, timing, verbose);
+			}
+		} catch (SocketTimeoutException e) {
+			System.out.println("Stream from " + source + " idle, closing.");
+		} catch (IOException e) {
+			System.out.println("Stream from " + source + ": " + e.getMessage());
+		} finally {
+			FrameSink.frameBuffers.release(frame);
+			close(client);
+			System.out.println("Stream from " + source + " closed after " + frames + " frames.");
+		}
+	}
+
+	private static void close(Socket client) {
+		try {
+			client.close();
+		} catch (IOException e) {
+			// Nothing left to do with it
+		}
+	}
+
+	public int getActiveStreams() {
+		return workers.getActiveCount();
+	}
+}
@@ -0,0 +1,109 @@
+package code;
+
+import java.util.Map;
+
+// Where the time of one frame went. The camera stamps its side in ms since
+// it booted (unsigned 32 bit, wrapping) and sends them with the frame; the
+// server stamps its side with System.nanoTime(). The two clocks are not
+// synchronized, so stages are only ever measured within one clock.
+//
+// The camera cannot know when a frame is sent before sending it, so each
+// frame carries the time the previous one finished sending.
+public class FrameTiming {
+	public static final int FLAG_MOTION = 0x01;	//Captured in a burst after the camera saw motion
+	static final String OPTION_SEQ = "seq";	//TFTP options the camera sends them as
+	static final String OPTION_CAPTURE_START = "tcap";
+	static final String OPTION_LENGTH_READ = "tlen";
+	static final String OPTION_READ_DONE = "tread";
+	static final String OPTION_PREV_SENT = "tsent";
+	static final String OPTION_FLAGS = "flags";
+	private static final String[] CAMERA_OPTIONS = {OPTION_SEQ, OPTION_CAPTURE_START, OPTION_LENGTH_READ,
+			OPTION_READ_DONE, OPTION_PREV_SENT, OPTION_FLAGS};
+
+	// Camera side, ms. 0 where the camera did not know the time yet.
+	long seq = -1;	//-1 if the camera sent no timestamps
+	long captureStart;
+	long lengthRead;	//Frame length read, the camera has the frame
+	long readDone;	//Whole frame read over the UART
+	long prevSent;	//Previous frame sent
+	int flags;
+
+	// Server side, System.nanoTime(). 0 where the frame never got there.
+	long requestReceived;	//WRQ or stream header, or RRQ sent in pull mode
+	long lastBlock;
+	long decodeStart;
+	long decodeEnd;
+	long displayed;
+
+	public FrameTiming(long requestReceived) {
+		this.requestReceived = requestReceived;
+	}
+
+	// Asks a camera in pull mode for the camera side, it fills them in in its OACK
+	static void addRequestOptions(Map<String, String> options) {
+		for (String name : CAMERA_OPTIONS) {
+			options.put(name, "0");
+		}
+	}
+
+	// Fills the camera side from the options of a write request or OACK, unknown or bad ones are left out
+	void setFromOptions(Map<String, String> options) {
+		try {
+			if (options.containsKey(OPTION_SEQ)) {
+				seq = Long.parseLong(options.get(OPTION_SEQ));
+			}
+			captureStart = parse(options, OPTION_CAPTURE_START);
+			lengthRead = parse(options, OPTION_LENGTH_READ);
+			readDone = parse(options, OPTION_READ_DONE);
+			prevSent = parse(options, OPTION_PREV_SENT);
+			flags = (int)parse(options, OPTION_FLAGS);
+		} catch (NumberFormatException e) {
+			seq = -1;
+		}
+	}
+
+	private static long parse(Map<String, String> options, String name) {
+		String value = options.get(name);
+		return value == null ? 0 : Long.parseLong(value);
+	}
+
+	public boolean hasDeviceTimes() {
+		return seq >= 0;
+	}
+
+	public boolean isMotion() {
+		return (flags & FLAG_MOTION) != 0;
+	}
+
+	// Camera interval in ms, -1 if either end is unknown. The camera clock wraps after 49 days.
+	static long deviceInterval(long from, long to) {
+		if (from == 0 || to == 0) {
+			return -1;
+		}
+		return (to - from) & 0xFFFFFFFFL;
+	}
+
+	// Server interval in ns, -1 if either end is unknown
+	static long serverInterval(long from, long to) {
+		if (from == 0 || to == 0) {
+			return -1;
+		}
+		return to - from;
+	}
+
+	public long getSeq() {
+		return seq;
+	}
+
+	public long getCaptureStart() {
+		return captureStart;
+	}
+
+	public long getReadDone() {
+		return readDone;
+	}
+
+	public long getLastBlock() {
+		return lastBlock;
+	}
+}
@@ -26,6 +26,10 @@ public class ImageLoader extends Component {
 		this.img = img;
 	}
 
+	public BufferedImage getImage() {
+		return img;
+	}
+
 	public void paint(Graphics g) {
 		g.drawImage(img, 0, 0, null);
 	}
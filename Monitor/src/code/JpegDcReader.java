@@ -0,0 +1,282 @@
+package code;
+
+// Reads the luma DC coefficient of every MCU of a baseline JPEG, a coarse
+// brightness map of the image (one value per 8x8 or 16x16 pixels). Only the
+// headers and the Huffman codes are decoded: AC coefficients are skipped, and
+// there is no dequantized block, IDCT, colour conversion or image allocated,
+// so it costs a fraction of a full decode.
+public class JpegDcReader {
+	private static final int MAXCODE = 0;	//Huffman table layout, by code length 1..16
+	private static final int VALPTR = 16;
+	private static final int MINCODE = 32;
+	private static final int VALUES = 49;
+	private static final int MAX_MCUS = 64 * 1024;	//2048x2048 at one block per MCU, larger sizes are taken as corrupt
+	private byte[] data;
+	private int length;
+	private int pos;
+	private int bitBuffer;
+	private int bitCount;
+	private int[][] dcTables = new int[4][];	//See huffmanTable()
+	private int[][] acTables = new int[4][];
+	private int[] quantDc = new int[4];	//DC entry of each quantization table
+
+	private JpegDcReader(byte[] data, int length) {
+		this.data = data;
+		this.length = length;
+	}
+
+	// DC of the first luma block of each MCU in raster order, scaled by the
+	// quantizer so values compare across quality settings. Null if the data
+	// is not a baseline or extended sequential Huffman JPEG, or is corrupt.
+	public static int[] readLumaDc(byte[] data, int length) {
+		try {
+			return new JpegDcReader(data, length).read();
+		} catch (ArrayIndexOutOfBoundsException | IllegalStateException e) {
+			return null;
+		}
+	}
+
+	private int[] read() {
+		if (length < 4 || (data[0] & 0xFF) != 0xFF || (data[1] & 0xFF) != 0xD8) {
+			return null;
+		}
+		pos = 2;
+
+		int width = 0, height = 0;
+		int components = 0;
+		int[] compIds = null, compH = null, compV = null, compQ = null;
+		int restartInterval = 0;
+
+		while (pos + 4 <= length) {
+			if ((data[pos] & 0xFF) != 0xFF) {
+				return null;
+			}
+			int marker = data[pos + 1] & 0xFF;
+			pos += 2;
+			if (marker == 0xFF || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+				if (marker == 0xFF) pos--;	//Fill byte
+				continue;
+			}
+			if (marker == 0xD9) {
+				return null;	//No scan
+			}
+			int segmentLength = u16(pos);
+			int segment = pos + 2;
+			int next = pos + segmentLength;
+
+			switch (marker) {
+			case 0xDB:	//DQT
+				while (segment < next) {
+					int precision = (data[segment] & 0xFF) >> 4;
+					int table = data[segment] & 0x0F;
+					quantDc[table] = precision == 0 ? data[segment + 1] & 0xFF : u16(segment + 1);
+					segment += 1 + 64 * (precision == 0 ? 1 : 2);
+				}
+				break;
+			case 0xC4:	//DHT
+				while (segment < next) {
+					int tableClass = (data[segment] & 0xFF) >> 4;
+					int table = data[segment] & 0x0F;
+					int[] huffman = huffmanTable(segment + 1);
+					(tableClass == 0 ? dcTables : acTables)[table] = huffman;
+					segment += 17 + huffman.length - VALUES;
+				}
+				break;
+			case 0xC0:	//SOF0 baseline
+			case 0xC1:	//SOF1 extended sequential, Huffman
+				height = u16(segment + 1);
+				width = u16(segment + 3);
+				components = data[segment + 5] & 0xFF;
+				compIds = new int[components];
+				compH = new int[components];
+				compV = new int[components];
+				compQ = new int[components];
+				for (int i = 0; i < components; i++) {
+					int c = segment + 6 + i * 3;
+					compIds[i] = data[c] & 0xFF;
+					compH[i] = (data[c + 1] & 0xFF) >> 4;
+					compV[i] = data[c + 1] & 0x0F;
+					compQ[i] = data[c + 2] & 0x0F;
+				}
+				break;
+			case 0xC2: case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+			case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF:
+				return null;	//Progressive, lossless, hierarchical or arithmetic coded
+			case 0xDD:	//DRI
+				restartInterval = u16(segment);
+				break;
+			case 0xDA:	//SOS
+				if (components == 0 || width == 0 || height == 0) {
+					return null;
+				}
+				int scanComponents = data[segment] & 0xFF;
+				if (scanComponents != components) {
+					return null;	//Non-interleaved scans, not produced by the cameras
+				}
+				int[] dcOf = new int[components];
+				int[] acOf = new int[components];
+				for (int i = 0; i < scanComponents; i++) {
+					int id = data[segment + 1 + i * 2] & 0xFF;
+					int tables = data[segment + 2 + i * 2] & 0xFF;
+					for (int j = 0; j < components; j++) {
+						if (compIds[j] == id) {
+							dcOf[j] = tables >> 4;
+							acOf[j] = tables & 0x0F;
+						}
+					}
+				}
+				pos = next;
+				return readScan(width, height, components, compH, compV, compQ, dcOf, acOf, restartInterval);
+			default:
+				break;
+			}
+			pos = next;
+		}
+		return null;
+	}
+
+	private int[] readScan(int width, int height, int components, int[] compH, int[] compV, int[] compQ,
+			int[] dcOf, int[] acOf, int restartInterval) {
+		int hMax = 1, vMax = 1;
+		for (int i = 0; i < components; i++) {
+			hMax = Math.max(hMax, compH[i]);
+			vMax = Math.max(vMax, compV[i]);
+		}
+		int mcusX, mcusY;
+		if (components == 1) {
+			// A single component scan has one block per MCU, whatever its sampling factors
+			mcusX = (width + 7) / 8;
+			mcusY = (height + 7) / 8;
+			compH[0] = compV[0] = 1;
+		} else {
+			mcusX = (width + 8 * hMax - 1) / (8 * hMax);
+			mcusY = (height + 8 * vMax - 1) / (8 * vMax);
+		}
+
+		int mcus = mcusX * mcusY;
+		if (mcus > MAX_MCUS) {
+			return null;
+		}
+		int[] dc = new int[mcus];
+		int[] predictors = new int[components];
+		for (int mcu = 0; mcu < mcus; mcu++) {
+			if (restartInterval > 0 && mcu > 0 && mcu % restartInterval == 0) {
+				restart(predictors);
+			}
+			for (int c = 0; c < components; c++) {
+				int[] dcTable = dcTables[dcOf[c]];
+				int[] acTable = acTables[acOf[c]];
+				if (dcTable == null || acTable == null) {
+					return null;
+				}
+				for (int block = 0; block < compH[c] * compV[c]; block++) {
+					int size = decode(dcTable);
+					predictors[c] += extend(bits(size), size);
+					if (c == 0 && block == 0) {
+						dc[mcu] = predictors[0] * Math.max(quantDc[compQ[0]], 1);
+					}
+					skipAc(acTable);
+				}
+			}
+		}
+		return dc;
+	}
+
+	private void skipAc(int[] table) {
+		for (int k = 1; k < 64; k++) {
+			int rs = decode(table);
+			int run = rs >> 4;
+			int size = rs & 0x0F;
+			if (size == 0) {
+				if (run != 15) return;	//End of block
+				k += 15;
+			} else {
+				k += run;
+				bits(size);
+			}
+		}
+	}
+
+	// Drops the bits left before a restart marker and the marker itself
+	private void restart(int[] predictors) {
+		bitBuffer = 0;
+		bitCount = 0;
+		while (pos + 1 < length && !((data[pos] & 0xFF) == 0xFF && (data[pos + 1] & 0xFF) >= 0xD0 && (data[pos + 1] & 0xFF) <= 0xD7)) {
+			pos++;
+		}
+		pos += 2;
+		for (int i = 0; i < predictors.length; i++) predictors[i] = 0;
+	}
+
+	// Canonical Huffman table from a DHT entry (JPEG F.2.2.3): maxcode,
+	// valptr and mincode for each code length, followed by the symbol values
+	private int[] huffmanTable(int offset) {
+		int total = 0;
+		for (int i = 0; i < 16; i++) total += data[offset + i] & 0xFF;
+		int[] table = new int[VALUES + total];
+		int code = 0;
+		int value = 0;
+		for (int bitsLength = 1; bitsLength <= 16; bitsLength++) {
+			int count = data[offset + bitsLength - 1] & 0xFF;
+			if (count == 0) {
+				table[MAXCODE + bitsLength] = -1;	//No code of this length
+			} else {
+				table[VALPTR + bitsLength] = value;
+				table[MINCODE + bitsLength] = code;
+				code += count;
+				value += count;
+				table[MAXCODE + bitsLength] = code - 1;
+			}
+			code <<= 1;
+		}
+		for (int i = 0; i < total; i++) table[VALUES + i] = data[offset + 16 + i] & 0xFF;
+		return table;
+	}
+
+	private int decode(int[] table) {
+		int code = bit();
+		for (int bitsLength = 1; bitsLength <= 16; bitsLength++) {
+			if (code <= table[MAXCODE + bitsLength]) {
+				return table[VALUES + table[VALPTR + bitsLength] + code - table[MINCODE + bitsLength]];
+			}
+			code = (code << 1) | bit();
+		}
+		throw new IllegalStateException("Bad Huffman code");
+	}
+
+	private static int extend(int value, int size) {
+		return (size > 0 && value < (1 << (size - 1))) ? value - (1 << size) + 1 : value;
+	}
+
+	private int bits(int count) {
+		int value = 0;
+		for (int i = 0; i < count; i++) value = (value << 1) | bit();
+		return value;
+	}
+
+	private int bit() {
+		if (bitCount == 0) {
+			if (pos >= length) {
+				throw new IllegalStateException("Scan ends early");
+			}
+			int b = data[pos] & 0xFF;
+			if (b == 0xFF) {
+				int next = pos + 1 < length ? data[pos + 1] & 0xFF : 0xD9;
+				if (next != 0x00) {
+					throw new IllegalStateException("Marker inside scan");
+				}
+				pos += 2;	//Stuffed zero
+			} else {
+				pos++;
+			}
+			bitBuffer = b;
+			bitCount = 8;
+		}
+		bitCount--;
+		return (bitBuffer >> bitCount) & 1;
+	}
+
+	private int u16(int offset) {
+		return ((data[offset] & 0xFF) << 8) | (data[offset + 1] & 0xFF);
+	}
+}
@@ -0,0 +1,84 @@
+package code;
+
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.atomic.AtomicLongArray;
+
+// Lock free histogram of durations in microseconds. Buckets grow
+// logarithmically, four per power of two, so any recorded value is within
+// 25% of the bucket it is reported as, from 1 us up to about 19 hours, in
+// 144 counters.
+public class LatencyHistogram {
+	private static final int SUB_BITS = 2;
+	private static final int SUB_BUCKETS = 1 << SUB_BITS;
+	private static final int MAX_EXPONENT = 36;	//2^36 us, longer values land in the last bucket
+	private static final int BUCKETS = (MAX_EXPONENT - SUB_BITS + 2) * SUB_BUCKETS;
+	private AtomicLongArray counts = new AtomicLongArray(BUCKETS);
+	private AtomicLong count = new AtomicLong();
+	private AtomicLong total = new AtomicLong();
+	private AtomicLong max = new AtomicLong();
+
+	public void record(long micros) {
+		if (micros < 0) {
+			return;	//Unknown, see FrameTiming
+		}
+		counts.incrementAndGet(bucketOf(micros));
+		count.incrementAndGet();
+		total.addAndGet(micros);
+		long current;
+		while (micros > (current = max.get()) && !max.compareAndSet(current, micros));
+	}
+
+	private static int bucketOf(long value) {
+		if (value < SUB_BUCKETS) {
+			return (int)value;
+		}
+		int exponent = 63 - Long.numberOfLeadingZeros(value);
+		if (exponent > MAX_EXPONENT) {
+			return BUCKETS - 1;
+		}
+		int sub = (int)(value >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+		return (exponent - SUB_BITS + 1) * SUB_BUCKETS + sub;
+	}
+
+	// Largest value that falls in a bucket
+	private static long upperBound(int bucket) {
+		if (bucket < SUB_BUCKETS) {
+			return bucket;
+		}
+		int exponent = bucket / SUB_BUCKETS + SUB_BITS - 1;
+		long lower = (long)(SUB_BUCKETS + bucket % SUB_BUCKETS) << (exponent - SUB_BITS);
+		return lower + (1L << (exponent - SUB_BITS)) - 1;
+	}
+
+	// Value (us) that the given fraction of recorded values are at or below,
+	// as the upper bound of its bucket; -1 if nothing was recorded
+	public long percentile(double fraction) {
+		long n = count.get();
+		if (n == 0) {
+			return -1;
+		}
+		long rank = Math.max((long)Math.ceil(fraction * n), 1);
+		long seen = 0;
+		for (int i = 0; i < BUCKETS; i++) {
+			seen += counts.get(i);
+			if (seen >= rank) {
+				return Math.min(upperBound(i), max.get());
+			}
+		}
+		return max.get();
+	}
+
+	public long getCount() {
+		return count.get();
+	}
+
+	public long getMax() {
+		return max.get();
+	}
+
+	// Mean in us, -1 if nothing was recorded
+	public long getMean() {
+		long n = count.get();
+		return n == 0 ? -1 : total.get() / n;
+	}
+}
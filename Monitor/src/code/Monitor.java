@@ -1,39 +1,66 @@
 package code;
 
+import java.awt.BorderLayout;
 import java.awt.Color;
 import java.awt.FlowLayout;
+import java.awt.GridLayout;
 import java.awt.event.ActionEvent;
 import java.awt.event.ActionListener;
+import java.awt.event.WindowEvent;
+import java.awt.event.WindowStateListener;
+import java.awt.image.BufferedImage;
+import java.io.IOException;
+import java.util.concurrent.ConcurrentHashMap;
 
 import javax.swing.JButton;
 import javax.swing.JFrame;
+import javax.swing.JLabel;
 import javax.swing.JPanel;
+import javax.swing.JScrollPane;
+import javax.swing.SwingUtilities;
 
 public class Monitor extends JFrame {
 
 	private static final long serialVersionUID = 1L;
 
-	private JPanel monitorPanel = new JPanel();
+	private GridLayout gridLayout = new GridLayout(0, 1, 4, 4);
+	private JPanel monitorPanel = new JPanel(gridLayout);
+	private JPanel buttonPanel = new JPanel(new FlowLayout());
+	private FrameCanvas readyCanvas = new FrameCanvas(null);
+	private ConcurrentHashMap<String, FrameCanvas> tiles = new ConcurrentHashMap<String, FrameCanvas>();	//By camera id
+	private ConcurrentHashMap<String, Frame> shown = new ConcurrentHashMap<String, Frame>();	//By camera id
 	private JButton btnStartServer = new JButton("Start Server");
 	private JButton btnStartTimer = new JButton("Start Timer");
-	
+	private JButton btnSaveClip = new JButton("Save Clip");
+	private volatile boolean iconified;	//Written on the event dispatch thread
+
 	public Monitor() {
 		super("Video Surveillance System");
-		setSize(260, 220);
+		setSize(360, 300);
 		this.getContentPane().setBackground(Color.WHITE);
 		setDefaultCloseOperation(EXIT_ON_CLOSE);
-		setLayout(new FlowLayout());
-		add(monitorPanel);
-		add(btnStartServer);
-		add(btnStartTimer);
+		setLayout(new BorderLayout());
+		add(new JScrollPane(monitorPanel), BorderLayout.CENTER);
+		buttonPanel.add(btnStartServer);
+		buttonPanel.add(btnStartTimer);
+		buttonPanel.add(btnSaveClip);
+		add(buttonPanel, BorderLayout.SOUTH);
+		addWindowStateListener(new WindowStateListener() {
+			public void windowStateChanged(WindowEvent e) {
+				iconified = (e.getNewState() & ICONIFIED) != 0;
+			}
+		});
 		setVisible(true);
 	}
 
 	public void initial() {
-		monitorPanel.setBounds(50, 20, 160, 120);
-		monitorPanel.setBackground(Color.WHITE);	
-		monitorPanel.add(new ImageLoader("resources/Ready.jpg"));
-		
+		monitorPanel.setBackground(Color.WHITE);
+		readyCanvas.showImage(new ImageLoader("resources/Ready.jpg").getImage());
+		monitorPanel.add(readyCanvas);
+
+		// One tile per camera, added when it sends its first frame
+		Start.getCameras().addListener(camera -> SwingUtilities.invokeLater(() -> addTile(camera)));
+
 		// Start button
 		btnStartServer.addActionListener(new ActionListener() {
 			public void actionPerformed(ActionEvent ev) {
@@ -46,26 +73,116 @@ public class Monitor extends JFrame {
 				startTimer();
 			}
 		});
+		// Clip button
+		btnSaveClip.addActionListener(new ActionListener() {
+			public void actionPerformed(ActionEvent ev) {
+				saveClip();
+			}
+		});
 		this.revalidate();
 	}
 
+	// Runs on the event dispatch thread
+	private void addTile(Camera camera) {
+		if (tiles.isEmpty()) {
+			monitorPanel.remove(readyCanvas);
+		}
+
+		FrameCanvas canvas = new FrameCanvas(null);
+		JPanel tile = new JPanel(new BorderLayout());
+		tile.setBackground(Color.WHITE);
+		tile.add(new JLabel(camera.getId()), BorderLayout.NORTH);
+		tile.add(canvas, BorderLayout.CENTER);
+		monitorPanel.add(tile);
+		tiles.put(camera.getId(), canvas);
+
+		// Keep the grid roughly square as cameras are added
+		gridLayout.setColumns((int)Math.ceil(Math.sqrt(tiles.size())));
+		monitorPanel.revalidate();
+	}
+
+	// Shows the newest frame of every camera whose tile can be seen. Frames of
+	// hidden tiles stay compressed in their rings, so they cost no decode.
+	// Runs on the monitor timer, so it reads no Swing state, only what the
+	// event dispatch thread keeps up to date.
 	public void fetchPic() {
-		if (!Start.getImgList().isEmpty()) {
-			monitorPanel.remove(0);
-			monitorPanel.add(new ImageLoader(Start.getImgList().getFirst()));
-			Start.getImgList().removeFirst();
-			this.revalidate();
-		} else {
+		if (iconified) {
+			return;
+		}
+
+		boolean buffered = false;
+		for (Camera camera : Start.getCameras().getCameras()) {
+			FrameCanvas canvas = tiles.get(camera.getId());
+			if (canvas == null || !canvas.isOnScreen()) {
+				continue;
+			}
+			camera.watched();	//Keeps a pulled camera sending
+
+			Frame frame = camera.getFrames().pollLatest();
+			if (frame == null) {
+				continue;
+			}
+			buffered = true;
+
+			// Only frames that are shown get decoded, at the size of their tile
+			FrameTiming timing = frame.getTiming();
+			if (timing != null) timing.decodeStart = System.nanoTime();
+			BufferedImage img;
+			try {
+				img = frame.getImage(canvas.getTileWidth(), canvas.getTileHeight());
+			} catch (IOException e) {
+				img = null;
+			}
+			if (img != null) {
+				if (timing != null) timing.decodeEnd = System.nanoTime();
+				canvas.showImage(img);
+
+				// The canvas holds what it shows, the frame before needs no images any more
+				Frame previous = shown.put(camera.getId(), frame);
+				if (previous != null && previous != frame) {
+					previous.releaseImages();
+				}
+				if (timing != null) {
+					timing.displayed = System.nanoTime();
+					camera.getStats().displayed(timing);
+				}
+			} else {
+				System.out.print("Received file is not an image: " + frame.getSource() + "\n");
+			}
+		}
+
+		if (!buffered) {
 			System.out.print("No images in the buffer!\n");
+			for (Camera camera : Start.getCameras().getCameras()) {
+				System.out.print("  " + camera + "\n");
+			}
 		}
 	}
 
 	private void startServer() {
-		Start.getServer().start();
+		// A server whose port was taken is left out
+		if (Start.getServer() != null) {
+			Start.getServer().start();
+		}
+		if (Start.getStreamServer() != null) {
+			Start.getStreamServer().start();
+		}
+		if (Start.getStatsServer() != null) {
+			Start.getStatsServer().start();
+		}
+		for (FramePuller puller : Start.getPullers()) {
+			puller.start();
+		}
 	}
 
 	private void startTimer() {
 		Start.getTimer().start();
 	}
 
+	private void saveClip() {
+		for (Camera camera : Start.getCameras().getCameras()) {
+			Start.getClips().trigger(camera, ClipRecorder.REASON_MANUAL);
+		}
+	}
+
 }
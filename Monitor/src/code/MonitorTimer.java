@@ -1,18 +1,45 @@
 package code;
 
+import java.awt.DisplayMode;
+import java.awt.GraphicsEnvironment;
+
+// Display thread: wakes up as soon as a frame is received from any camera
+// and has the monitor show the newest one of each. Bursts are coalesced to the display refresh
+// rate, frames arriving faster than that are skipped.
 public class MonitorTimer extends Thread {
+	private static int DEFAULT_REFRESH_RATE = 60;	//Hz, when the display does not report one
+	private static int IDLE_TIMEOUT = 2000;	//Report an empty buffer after this long without frames (ms)
+	private long frameInterval;
 
 	public MonitorTimer() {
-
+		int refreshRate = DEFAULT_REFRESH_RATE;
+		try {
+			DisplayMode mode = GraphicsEnvironment.getLocalGraphicsEnvironment().getDefaultScreenDevice().getDisplayMode();
+			if (mode.getRefreshRate() != DisplayMode.REFRESH_RATE_UNKNOWN) {
+				refreshRate = mode.getRefreshRate();
+			}
+		} catch (Exception e) {
+			// Headless or no display mode, keep the default
+		}
+		frameInterval = 1000 / refreshRate;
 	}
 
 	public void run() {
 		System.out.println("Timer started!");
+		long lastShown = 0;
 		while (true) {
 			try {
-				//Tick every 1s
-				//Thread.sleep(1000);
-				Thread.sleep(2000);
+				if (!Start.getCameras().awaitFrame(IDLE_TIMEOUT)) {
+					tick();
+					continue;
+				}
+
+				// At most one frame per display refresh
+				long wait = lastShown + frameInterval - System.currentTimeMillis();
+				if (wait > 0) {
+					Thread.sleep(wait);
+				}
+				lastShown = System.currentTimeMillis();
 				tick();
 			} catch (InterruptedException e) {
 				e.printStackTrace();
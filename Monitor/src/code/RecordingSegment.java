@@ -0,0 +1,159 @@
+package code;
+
+import java.io.File;
+import java.io.IOException;
+import java.io.RandomAccessFile;
+import java.nio.ByteBuffer;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+
+// One segment of a camera's recording: a data file of frames appended back
+// to back, and a sidecar index with one fixed size entry per frame. Both
+// are only ever appended to. Files are named after the time the segment was
+// started.
+//
+// Data record:  timestamp(8) length(4) JPEG(length)
+// Index entry:  timestamp(8) offset of the record(8)
+//
+// Index timestamps never decrease, so a timestamp is found by binary search
+// over the memory-mapped index. An index entry is written after its record,
+// so it never points past the data, even after a crash.
+public class RecordingSegment {
+	static String DATA_SUFFIX = ".seg";
+	static String INDEX_SUFFIX = ".idx";
+	static int RECORD_HEADER_SIZE = 12;
+	static int INDEX_ENTRY_SIZE = 16;
+	private long startTime;
+	private FileChannel data;
+	private FileChannel index;
+	private ByteBuffer recordHeader = ByteBuffer.allocate(RECORD_HEADER_SIZE);
+	private ByteBuffer indexEntry = ByteBuffer.allocate(INDEX_ENTRY_SIZE);
+	private long size;
+	private long lastTimestamp;
+
+	private RecordingSegment(File dir, long startTime) throws IOException {
+		this.startTime = startTime;
+		lastTimestamp = startTime;
+		data = new RandomAccessFile(dataFile(dir, startTime), "rw").getChannel();
+		index = new RandomAccessFile(indexFile(dir, startTime), "rw").getChannel();
+		data.truncate(0);
+		index.truncate(0);
+	}
+
+	public static RecordingSegment create(File dir, long startTime) throws IOException {
+		return new RecordingSegment(dir, startTime);
+	}
+
+	static File dataFile(File dir, long startTime) {
+		return new File(dir, String.format("%013d", startTime) + DATA_SUFFIX);
+	}
+
+	static File indexFile(File dir, long startTime) {
+		return new File(dir, String.format("%013d", startTime) + INDEX_SUFFIX);
+	}
+
+	// Start time of a segment from its data file name, -1 if it is not one
+	static long startTimeOf(File file) {
+		String name = file.getName();
+		if (!name.endsWith(DATA_SUFFIX)) {
+			return -1;
+		}
+		try {
+			return Long.parseLong(name.substring(0, name.length() - DATA_SUFFIX.length()));
+		} catch (NumberFormatException e) {
+			return -1;
+		}
+	}
+
+	// Appends one frame, both writes are sequential
+	public void append(long timestamp, byte[] frame, int length) throws IOException {
+		timestamp = Math.max(timestamp, lastTimestamp);	//The clock may step back, the index must not
+
+		recordHeader.clear();
+		recordHeader.putLong(timestamp).putInt(length).flip();
+		ByteBuffer[] record = {recordHeader, ByteBuffer.wrap(frame, 0, length)};
+		while (record[0].hasRemaining() || record[1].hasRemaining()) {
+			data.write(record);
+		}
+
+		indexEntry.clear();
+		indexEntry.putLong(timestamp).putLong(size).flip();
+		while (indexEntry.hasRemaining()) {
+			index.write(indexEntry);
+		}
+
+		size += RECORD_HEADER_SIZE + length;
+		lastTimestamp = timestamp;
+	}
+
+	public long getStartTime() {
+		return startTime;
+	}
+
+	public long getSize() {
+		return size;
+	}
+
+	public void close() throws IOException {
+		data.close();
+		index.close();
+	}
+
+	// Position of the last index entry with a timestamp at or before the
+	// given one, -1 if the segment starts later
+	static int floorEntry(MappedByteBuffer index, long timestamp) {
+		int low = 0;
+		int high = index.capacity() / INDEX_ENTRY_SIZE - 1;
+		int found = -1;
+		while (low <= high) {
+			int mid = (low + high) >>> 1;
+			if (index.getLong(mid * INDEX_ENTRY_SIZE) <= timestamp) {
+				found = mid;
+				low = mid + 1;
+			} else {
+				high = mid - 1;
+			}
+		}
+		return found;
+	}
+
+	// Position of the first index entry with a timestamp at or after the given one
+	static int ceilingEntry(MappedByteBuffer index, long timestamp) {
+		int entry = floorEntry(index, timestamp);
+		if (entry >= 0 && index.getLong(entry * INDEX_ENTRY_SIZE) == timestamp) {
+			// Equal timestamps, go back to the first of them
+			while (entry > 0 && index.getLong((entry - 1) * INDEX_ENTRY_SIZE) == timestamp) entry--;
+			return entry;
+		}
+		return entry + 1;
+	}
+
+	// Maps a whole file for reading, only the complete index entries of a segment being written
+	static MappedByteBuffer map(File file, int entrySize) throws IOException {
+		try (FileChannel channel = new RandomAccessFile(file, "r").getChannel()) {
+			long length = channel.size();
+			if (entrySize > 1) length -= length % entrySize;
+			return channel.map(FileChannel.MapMode.READ_ONLY, 0, length);
+		}
+	}
+
+	static long entryTimestamp(MappedByteBuffer index, int entry) {
+		return index.getLong(entry * INDEX_ENTRY_SIZE);
+	}
+
+	static int entryCount(MappedByteBuffer index) {
+		return index.capacity() / INDEX_ENTRY_SIZE;
+	}
+
+	// Frame of an index entry, read from the mapped data file
+	static Frame readFrame(String cameraId, MappedByteBuffer data, MappedByteBuffer index, int entry) {
+		long offset = index.getLong(entry * INDEX_ENTRY_SIZE + 8);
+		long timestamp = data.getLong((int)offset);
+		int length = data.getInt((int)offset + 8);
+		byte[] frame = new byte[length];
+		ByteBuffer view = data.duplicate();
+		view.position((int)offset + RECORD_HEADER_SIZE);
+		view.get(frame);
+		return new Frame(cameraId, timestamp, frame);
+	}
+}
@@ -0,0 +1,166 @@
+package code;
+
+import java.io.File;
+import java.io.IOException;
+import java.nio.MappedByteBuffer;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.function.Consumer;
+
+// Records the compressed frames of every camera to disk, one directory per
+// camera holding a series of RecordingSegment files. A camera's current
+// segment is rotated once it is large or old enough, and the oldest segments
+// are deleted to keep each camera within its size and age limits. Playback
+// maps the segment files and binary searches their indexes, so any time is
+// found in O(log n) however long the recording.
+public class RecordingStore {
+	private static long SEGMENT_SIZE = 64L * 1024 * 1024;	//Rotate after this many bytes...
+	private static long SEGMENT_DURATION = 10 * 60 * 1000;	//...or this many ms
+	private File root;
+	private long maxBytes;	//Per camera
+	private long maxAge;	//ms
+	private ConcurrentHashMap<String, CameraRecording> recordings = new ConcurrentHashMap<String, CameraRecording>();
+
+	public RecordingStore(File root, long maxBytes, long maxAge) {
+		this.root = root;
+		this.maxBytes = maxBytes;
+		this.maxAge = maxAge;
+	}
+
+	// Called from the receiving threads, frames of one camera are appended in order
+	public void append(String cameraId, Frame frame) throws IOException {
+		CameraRecording recording = recordings.computeIfAbsent(cameraId, id -> new CameraRecording(cameraDir(id)));
+		recording.append(frame);
+	}
+
+	// Last frame recorded at or before timestamp, null if there is none
+	public Frame find(String cameraId, long timestamp) throws IOException {
+		File dir = cameraDir(cameraId);
+		long[] starts = segmentStarts(dir);
+
+		// Segment that started last at or before timestamp, else the one before it
+		int segment = Arrays.binarySearch(starts, timestamp);
+		if (segment < 0) segment = -segment - 2;
+		for (; segment >= 0; segment--) {
+			MappedByteBuffer index = RecordingSegment.map(RecordingSegment.indexFile(dir, starts[segment]), RecordingSegment.INDEX_ENTRY_SIZE);
+			int entry = RecordingSegment.floorEntry(index, timestamp);
+			if (entry >= 0) {
+				MappedByteBuffer data = RecordingSegment.map(RecordingSegment.dataFile(dir, starts[segment]), 1);
+				return RecordingSegment.readFrame(cameraId, data, index, entry);
+			}
+		}
+		return null;
+	}
+
+	// Hands every frame recorded from from to to (inclusive) to consumer, in order
+	public void read(String cameraId, long from, long to, Consumer<Frame> consumer) throws IOException {
+		File dir = cameraDir(cameraId);
+		long[] starts = segmentStarts(dir);
+
+		int segment = Arrays.binarySearch(starts, from);
+		if (segment < 0) segment = Math.max(-segment - 2, 0);
+		for (; segment < starts.length && starts[segment] <= to; segment++) {
+			MappedByteBuffer index = RecordingSegment.map(RecordingSegment.indexFile(dir, starts[segment]), RecordingSegment.INDEX_ENTRY_SIZE);
+			MappedByteBuffer data = null;
+			int count = RecordingSegment.entryCount(index);
+			for (int entry = RecordingSegment.ceilingEntry(index, from); entry < count; entry++) {
+				if (RecordingSegment.entryTimestamp(index, entry) > to) return;
+				if (data == null) data = RecordingSegment.map(RecordingSegment.dataFile(dir, starts[segment]), 1);
+				consumer.accept(RecordingSegment.readFrame(cameraId, data, index, entry));
+			}
+		}
+	}
+
+	public void close() {
+		for (CameraRecording recording : recordings.values()) {
+			recording.close();
+		}
+	}
+
+	private File cameraDir(String cameraId) {
+		return new File(root, CameraRegistry.fileName(cameraId));
+	}
+
+	// Start times of the segments of a camera, oldest first
+	private static long[] segmentStarts(File dir) {
+		File[] files = dir.listFiles();
+		if (files == null) {
+			return new long[0];
+		}
+		List<Long> starts = new ArrayList<Long>();
+		for (File file : files) {
+			long start = RecordingSegment.startTimeOf(file);
+			if (start >= 0) starts.add(start);
+		}
+		long[] sorted = new long[starts.size()];
+		for (int i = 0; i < sorted.length; i++) sorted[i] = starts.get(i);
+		Arrays.sort(sorted);
+		return sorted;
+	}
+
+	// Segments of one camera, written by one thread at a time
+	private class CameraRecording {
+		private File dir;
+		private RecordingSegment current;
+
+		CameraRecording(File dir) {
+			this.dir = dir;
+		}
+
+		synchronized void append(Frame frame) throws IOException {
+			long now = frame.getReceivedAt();
+			if (current == null || current.getSize() >= SEGMENT_SIZE || now - current.getStartTime() >= SEGMENT_DURATION) {
+				rotate(now);
+			}
+			current.append(frame.getReceivedAt(), frame.getData(), frame.getData().length);
+		}
+
+		private void rotate(long now) throws IOException {
+			if (current != null) {
+				current.close();
+				current = null;
+			}
+			if (!dir.isDirectory() && !dir.mkdirs()) {
+				throw new IOException("Cannot create recording directory " + dir);
+			}
+			// Never reuse a name, a restart within the same ms would truncate a segment
+			long start = now;
+			while (RecordingSegment.dataFile(dir, start).exists()) start++;
+			current = RecordingSegment.create(dir, start);
+			enforceRetention(now);
+		}
+
+		// Deletes the oldest segments while the camera is over its limits, never the current one
+		private void enforceRetention(long now) {
+			long[] starts = segmentStarts(dir);
+			long total = 0;
+			for (long start : starts) {
+				total += RecordingSegment.dataFile(dir, start).length() + RecordingSegment.indexFile(dir, start).length();
+			}
+			for (int i = 0; i < starts.length - 1 && starts[i] != current.getStartTime(); i++) {
+				boolean expired = starts[i + 1] < now - maxAge;	//Next segment started after its last frame
+				if (!expired && total <= maxBytes) {
+					break;
+				}
+				File data = RecordingSegment.dataFile(dir, starts[i]);
+				File index = RecordingSegment.indexFile(dir, starts[i]);
+				total -= data.length() + index.length();
+				index.delete();
+				data.delete();
+			}
+		}
+
+		synchronized void close() {
+			if (current != null) {
+				try {
+					current.close();
+				} catch (IOException e) {
+					e.printStackTrace();
+				}
+				current = null;
+			}
+		}
+	}
+}
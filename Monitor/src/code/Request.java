@@ -2,6 +2,8 @@ package code;
 
 import java.io.File;
 import java.nio.file.Path;
+import java.util.Collections;
+import java.util.Map;
 
 // Class to encapsulate data about a request
 public class Request {
@@ -12,11 +14,17 @@ public class Request {
 	private Type type;
 	private String filePath;
 	private String mode;
+	private Map<String, String> options;
 
 	public Request(Type t, String f, String m) {
+		this(t, f, m, Collections.<String, String>emptyMap());
+	}
+
+	public Request(Type t, String f, String m, Map<String, String> o) {
 		type = t;
 		filePath = f;
 		mode = m;
+		options = o;
 	}
 
 	public Type getType() {
@@ -36,4 +44,9 @@ public class Request {
 	public String getMode() {
 		return mode;
 	}
+
+	// Options (RFC 2347) of the request, names in lower case
+	public Map<String, String> getOptions() {
+		return options;
+	}
 }
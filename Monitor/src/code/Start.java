@@ -1,25 +1,69 @@
 package code;
 
-import java.awt.image.BufferedImage;
+import java.io.File;
 import java.io.IOException;
-import java.util.LinkedList;
+import java.net.UnknownHostException;
+import java.util.ArrayList;
+import java.util.List;
 
 public class Start {
 
-	public static LinkedList<BufferedImage> ImgList = new LinkedList<BufferedImage>();
+	private static String RECORD_ARG = "-record";	//Turns on recording, it is off without it
+	private static String RECORDING_DIR = "recordings";
+	private static long RECORDING_MAX_BYTES = 1024L * 1024 * 1024;	//Kept per camera, oldest segments go first
+	private static long RECORDING_MAX_AGE = 24L * 60 * 60 * 1000;	//ms
+	private static String CLIP_DIR = "clips";
+	private static long CLIP_PRE_MS = 10000;	//Saved before a trigger, as far as the camera history reaches
+	private static long CLIP_POST_MS = 10000;	//Saved after a trigger
+
+	// Filled by the server's transfer workers, emptied by the monitor timer
+	public static CameraRegistry cameras = new CameraRegistry();
+	public static RecordingStore recorder;	//null unless recording
+	public static ClipRecorder clips = new ClipRecorder(new File(CLIP_DIR), CLIP_PRE_MS, CLIP_POST_MS);
 	public static Monitor monitor;
 	public static TFTPServer server;
+	public static FrameStreamServer streamServer;
+	public static StatsServer statsServer;
+	public static List<FramePuller> pullers = new ArrayList<FramePuller>();
 	public static MonitorTimer timer;
 
 	public static void main(String[] args) {
 
-		// TFTP server initial
+		// TFTP server initial, each on its own so a port in use only loses that server
 		try {
 			server = new TFTPServer();
-
 		} catch (IOException e) {
 			e.printStackTrace();
 		}
+		try {
+			streamServer = new FrameStreamServer();
+		} catch (IOException e) {
+			e.printStackTrace();
+		}
+		try {
+			statsServer = new StatsServer();
+		} catch (IOException e) {
+			System.out.println("Stats server not available on port " + StatsServer.PORT + ": " + e.getMessage());
+		}
+
+		// Cameras in pull mode are named on the command line as [name@]host[:port]
+		for (String arg : args) {
+			if (arg.equals(RECORD_ARG)) {
+				startRecording();
+				continue;
+			}
+			try {
+				pullers.add(new FramePuller(arg));
+			} catch (UnknownHostException | IllegalArgumentException e) {
+				System.out.println("Not a camera: " + arg + " (" + e.getMessage() + ")");
+			}
+		}
+
+		// Close the open recording segments on exit
+		if (recorder != null) {
+			RecordingStore store = recorder;
+			Runtime.getRuntime().addShutdownHook(new Thread(() -> store.close()));
+		}
 
 		// Start Timer
 		timer = new MonitorTimer();
@@ -30,14 +74,40 @@ public class Start {
 
 	}
 
-	public static LinkedList<BufferedImage> getImgList() {
-		return Start.ImgList;
+	// Records every camera's frames from now on, see RecordingStore
+	public static void startRecording() {
+		recorder = new RecordingStore(new File(RECORDING_DIR), RECORDING_MAX_BYTES, RECORDING_MAX_AGE);
+		System.out.println("Recording to " + new File(RECORDING_DIR).getAbsolutePath() + ".");
+	}
+
+	public static CameraRegistry getCameras() {
+		return Start.cameras;
+	}
+
+	public static RecordingStore getRecorder() {
+		return Start.recorder;
+	}
+
+	public static ClipRecorder getClips() {
+		return Start.clips;
 	}
 
 	public static TFTPServer getServer() {
 		return Start.server;
 	}
 
+	public static FrameStreamServer getStreamServer() {
+		return Start.streamServer;
+	}
+
+	public static StatsServer getStatsServer() {
+		return Start.statsServer;
+	}
+
+	public static List<FramePuller> getPullers() {
+		return Start.pullers;
+	}
+
 	public static Monitor getMonitor() {
 		return Start.monitor;
 	}
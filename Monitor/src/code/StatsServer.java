@@ -0,0 +1,109 @@
+package code;
+
+import java.io.IOException;
+import java.io.OutputStream;
+import java.net.InetSocketAddress;
+import java.nio.charset.StandardCharsets;
+import java.util.Locale;
+import java.util.concurrent.Executors;
+
+import com.sun.net.httpserver.HttpExchange;
+import com.sun.net.httpserver.HttpServer;
+
+// Serves the per-camera statistics as JSON over HTTP, for scripts and
+// dashboards:
+//   GET /stats              all cameras
+//   GET /stats?camera=<id>  one camera
+// Latencies are in microseconds, p50 and p99 as bucket upper bounds (see
+// LatencyHistogram), -1 for stages with no frames yet.
+public class StatsServer {
+	static int PORT = 8080;
+	private HttpServer server;
+
+	public StatsServer() throws IOException {
+		server = HttpServer.create(new InetSocketAddress(PORT), 0);
+		server.createContext("/stats", this::handle);
+		server.setExecutor(Executors.newSingleThreadExecutor());
+	}
+
+	public void start() {
+		server.start();
+		System.out.println("Stats server started on port " + PORT + ".");
+	}
+
+	private void handle(HttpExchange exchange) throws IOException {
+		String query = exchange.getRequestURI().getQuery();
+		String cameraId = null;
+		if (query != null && query.startsWith("camera=")) {
+			cameraId = query.substring("camera=".length());
+		}
+
+		int status = 200;
+		String body;
+		if (cameraId != null) {
+			Camera camera = Start.getCameras().get(cameraId);
+			if (camera == null) {
+				status = 404;
+				body = "{\"error\":\"unknown camera\"}";
+			} else {
+				body = toJson(camera);
+			}
+		} else {
+			StringBuilder json = new StringBuilder("{\"cameras\":[");
+			boolean first = true;
+			for (Camera camera : Start.getCameras().getCameras()) {
+				if (!first) json.append(',');
+				json.append(toJson(camera));
+				first = false;
+			}
+			body = json.append("]}").toString();
+		}
+
+		byte[] bytes = body.getBytes(StandardCharsets.UTF_8);
+		exchange.getResponseHeaders().set("Content-Type", "application/json");
+		exchange.sendResponseHeaders(status, bytes.length);
+		try (OutputStream out = exchange.getResponseBody()) {
+			out.write(bytes);
+		}
+	}
+
+	static String toJson(Camera camera) {
+		CameraStats stats = camera.getStats();
+		StringBuilder json = new StringBuilder();
+		json.append("{\"camera\":").append(quote(camera.getId()));
+		json.append(",\"frames\":").append(stats.getFrames());
+		json.append(",\"lost\":").append(stats.getLost());
+		json.append(",\"late\":").append(stats.getLate());
+		json.append(",\"restarts\":").append(stats.getRestarts());
+		json.append(",\"unchanged\":").append(camera.getUnchanged());
+		json.append(",\"dropped\":").append(camera.getFrames().getDropped());
+		json.append(",\"bytes\":").append(camera.getBytesReceived());
+		json.append(",\"jitter_ms\":").append(String.format(Locale.ROOT, "%.3f", stats.getJitter()));
+		json.append(",\"stages\":{");
+		for (int i = 0; i < CameraStats.STAGES.length; i++) {
+			LatencyHistogram stage = stats.stage(CameraStats.STAGES[i]);
+			if (i > 0) json.append(',');
+			json.append(quote(CameraStats.STAGES[i])).append(":{");
+			json.append("\"count\":").append(stage.getCount());
+			json.append(",\"p50\":").append(stage.percentile(0.5));
+			json.append(",\"p99\":").append(stage.percentile(0.99));
+			json.append(",\"max\":").append(stage.getMax());
+			json.append('}');
+		}
+		return json.append("}}").toString();
+	}
+
+	private static String quote(String value) {
+		StringBuilder quoted = new StringBuilder("\"");
+		for (char c : value.toCharArray()) {
+			if (c == '"' || c == '\\') {
+				quoted.append('\\').append(c);
+			} else if (c < 0x20) {
+				quoted.append(String.format("\\u%04x", (int)c));
+			} else {
+				quoted.append(c);
+			}
+		}
+		return quoted.append('"').toString();
+	}
+}
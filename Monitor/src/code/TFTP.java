@@ -1,6 +1,7 @@
 package code;
 
 import java.net.*;
+import java.nio.ByteBuffer;
 import java.nio.file.DirectoryNotEmptyException;
 import java.nio.file.Files;
 import java.nio.file.NoSuchFileException;
@@ -21,6 +22,7 @@ public class TFTP {
 	public static final int DATA_OP_CODE = 3;
 	public static final int ACK_OP_CODE = 4;
 	public static final int ERROR_OP_CODE = 5;
+	public static final int OACK_OP_CODE = 6;
 	public static final int ERROR_CODE_SIZE = 2;
 	public static final int ERROR_CODE_NOT_DEFINED = 0;
 	public static final int ERROR_CODE_FILE_NOT_FOUND = 1;
@@ -29,11 +31,18 @@ public class TFTP {
 	public static final int ERROR_CODE_ILLEGAL_TFTP_OPERATION = 4;
 	public static final int ERROR_CODE_UNKNOWN_TID = 5;
 	public static final int ERROR_CODE_NO_SUCH_USER = 7;
+	public static final int ERROR_CODE_OPTION_NEGOTIATION = 8;
 	public static final int MIN_PORT = 1;
 	public static final int MAX_PORT = 65535;
-	public static final int MAX_ERROR_CODE = 7;
-	public static final int MAX_OP_CODE = 5;
+	public static final int MAX_ERROR_CODE = 8;
+	public static final int MAX_OP_CODE = 6;
 	public static final int MAX_BLOCK_NUMBER = 65535;
+	public static final int MIN_BLKSIZE = 8;
+	public static final int MAX_BLKSIZE = 1468;		// Largest block that fits an Ethernet MTU
+	public static final int MAX_WINDOWSIZE = 16;
+	public static final String OPTION_BLKSIZE = "blksize";
+	public static final String OPTION_TSIZE = "tsize";
+	public static final String OPTION_WINDOWSIZE = "windowsize";
 	public static final String MODE_NETASCII = "netascii";
 	public static final String MODE_OCTET = "octet";
 	public static int VERBOSITY = 1;
@@ -49,6 +58,19 @@ public class TFTP {
 		return new DatagramPacket(data, data.length);
 	}
 
+	/**
+	 * Forms a DatagramPacket with an empty data buffer large enough to hold a DATA
+	 * packet of a transfer that negotiated the block size blockSize
+	 *
+	 * @param blockSize Negotiated block size (RFC 2348)
+	 *
+	 * @return DatagramPacket with an empty data buffer of one more byte than the largest DATA packet
+	 */
+	public static DatagramPacket formPacket(int blockSize) {
+		byte[] data = new byte[OP_CODE_SIZE + BLOCK_NUMBER_SIZE + blockSize + 1];
+		return new DatagramPacket(data, data.length);
+	}
+
 	/**
 	 * Forms a DatagramPacket with the byte[] data passed in
 	 *
@@ -64,7 +86,8 @@ public class TFTP {
 	
 	/**
 	 * Forms a DatagramPacket using Request r with information about request type
-	 * (read, write, or test), filename, and mode (ascii, octet, etc.).
+	 * (read, write, or test), filename, and mode (ascii, octet, etc.), followed by
+	 * the options (RFC 2347) of the request.
 	 *
 	 * @param addr InetAddress of packet destination
 	 * @param port Port number of packet destination
@@ -108,11 +131,20 @@ public class TFTP {
 		currentIndex = currentIndex + mbytes.length;
 		buf[currentIndex] = TFTP_PADDING;
 
-		// Truncate trailing zeros by copyings to a new array
-		byte[] data = new byte[currentIndex + 1];
-		System.arraycopy(buf,0,data,0,currentIndex+1);
+		// Truncate trailing zeros by copying the request and its options, name, 0, value, 0 each
+		ByteArrayOutputStream out = new ByteArrayOutputStream();
+		out.write(buf, 0, currentIndex + 1);
+		for (Map.Entry<String, String> option : r.getOptions().entrySet()) {
+			byte[] name = option.getKey().getBytes();
+			byte[] value = option.getValue().getBytes();
+			out.write(name, 0, name.length);
+			out.write(TFTP_PADDING);
+			out.write(value, 0, value.length);
+			out.write(TFTP_PADDING);
+		}
 
-		return new DatagramPacket(data,currentIndex+1, addr, port);
+		byte[] data = out.toByteArray();
+		return new DatagramPacket(data, data.length, addr, port);
 	}
 
 	/**
@@ -279,7 +311,7 @@ public class TFTP {
 	 * @return boolean telling if the op code is valid
 	 */
 	public static boolean isValidOpCode(int opCode) {
-		return opCode >= 1 && opCode <= 5;
+		return opCode >= 1 && opCode <= MAX_OP_CODE;
 	}
 
 	/**
@@ -309,6 +341,41 @@ public class TFTP {
 		return blockNumber;
 	}
 
+	/**
+	 * Returns the OP code of a received packet, read in place from a view of its buffer.
+	 *
+	 * @param packet View of a TFTP packet, limited to the received length
+	 *
+	 * @return The OP code of the TFTP packet
+	 */
+	public static int getOpCode(ByteBuffer packet) {
+		return packet.getShort(0) & 0xFFFF;
+	}
+
+	/**
+	 * Returns the block number of a received DATA or ACK packet, read in place from a view
+	 * of its buffer.
+	 *
+	 * @param packet View of a TFTP DATA or ACK packet, limited to the received length
+	 *
+	 * @return The block number of the ACK or DATA packet
+	 */
+	public static int getBlockNumber(ByteBuffer packet) {
+		return packet.getShort(OP_CODE_SIZE) & 0xFFFF;
+	}
+
+	/**
+	 * Sets the block number of a DATA or ACK packet in place, so one packet can be sent
+	 * for every block of a transfer.
+	 *
+	 * @param packet A TFTP DATA or ACK packet
+	 * @param blockNumber New block number of the packet
+	 */
+	public static void setBlockNumber(DatagramPacket packet, int blockNumber) {
+		if (!isValidBlockNumber(blockNumber)) throw new IllegalArgumentException("Block number out of range.");
+		ByteBuffer.wrap(packet.getData()).putShort(OP_CODE_SIZE, (short)blockNumber);
+	}
+
 	/**
 	 * Checks the validity of the block number blockNumber supplied
 	 *
@@ -533,6 +600,36 @@ public class TFTP {
 		return new DatagramPacket(buf, buf.length, addr, port);	
 	}
 
+	/**
+	 * Forms an OACK packet (RFC 2347) acknowledging the given options.
+	 *
+	 * @param addr IP address of destination of the packet to be sent
+	 * @param port Port number of destination of the packet to be sent
+	 * @param options Accepted options and their values, in the order to send them
+	 *
+	 * @return OACK packet formed with given inputs
+	 */
+	public static DatagramPacket formOACKPacket(InetAddress addr, int port, Map<String, String> options) {
+		ByteArrayOutputStream buf = new ByteArrayOutputStream();
+
+		// Op code
+		buf.write(0);
+		buf.write(OACK_OP_CODE);
+
+		// Option name, 0, value, 0
+		for (Map.Entry<String, String> option : options.entrySet()) {
+			byte[] name = option.getKey().getBytes();
+			byte[] value = option.getValue().getBytes();
+			buf.write(name, 0, name.length);
+			buf.write(0);
+			buf.write(value, 0, value.length);
+			buf.write(0);
+		}
+
+		byte[] data = buf.toByteArray();
+		return new DatagramPacket(data, data.length, addr, port);
+	}
+
 	/**
 	 * Verify validity of REQUEST PACKET and populates errorMessage[0] is an error occurs
 	 * 
@@ -644,11 +741,34 @@ public class TFTP {
 			}
 			offset.incrementOffset(1);
 
-			// Check if the final position of the offset is at the last data byte
-			if (offset.getOffset() != dataLength)
+			// Options (RFC 2347) may follow the mode as name, 0, value, 0 pairs
+			while (offset.getOffset() != dataLength)
 			{
-				errorMessage[0] = "No termination after final 0 byte";
-				return false;
+				// Option name
+				int optionStartOffset = offset.getOffset();
+				while (data[offset.getOffset()] != 0)
+				{
+					offset.incrementOffset(1);
+				}
+				if (offset.getOffset() == optionStartOffset)
+				{
+					errorMessage[0] = "Missing option name";
+					return false;
+				}
+				offset.incrementOffset(1);
+
+				// Option value
+				int valueStartOffset = offset.getOffset();
+				while (data[offset.getOffset()] != 0)
+				{
+					offset.incrementOffset(1);
+				}
+				if (offset.getOffset() == valueStartOffset)
+				{
+					errorMessage[0] = "Missing option value";
+					return false;
+				}
+				offset.incrementOffset(1);
 			}
 
 			return true;
@@ -669,6 +789,22 @@ public class TFTP {
 	 * @return Returns true if DATA packet matches TFTP specifications
 	 */
 	public static boolean verifyDataPacket(DatagramPacket packet, int blockNumber, String[] errorMessage)
+	{
+		return verifyDataPacket(packet, blockNumber, MAX_DATA_SIZE, errorMessage);
+	}
+
+	/**
+	 * Verify validity of DATA PACKET of a transfer that negotiated the block size blockSize
+	 * and populates errorMessage[0] is an error occurs
+	 * 
+	 * @param packet TFTP DATA packet
+	 * @param blockNumber Highest block number accepted, ahead of the expected block when windowing
+	 * @param blockSize Negotiated block size (RFC 2348)
+	 * @param errorMessage String[] which is populated with error message if invalid (index 0)
+	 * 
+	 * @return Returns true if DATA packet matches TFTP specifications
+	 */
+	public static boolean verifyDataPacket(DatagramPacket packet, int blockNumber, int blockSize, String[] errorMessage)
 	{
 		assert((blockNumber >= 0) && (blockNumber <= MAX_BLOCK_NUMBER));
 
@@ -680,7 +816,7 @@ public class TFTP {
 		try
 		{
 			// Check if the data packet is a valid size
-			if (dataLength > MAX_PACKET_SIZE)
+			if (dataLength > OP_CODE_SIZE + BLOCK_NUMBER_SIZE + blockSize)
 			{
 				errorMessage[0] = "Packet too large";
 				return false;
@@ -728,6 +864,59 @@ public class TFTP {
 		}
 	}
 
+	/**
+	 * Verify validity of a received DATA PACKET in place, without copying it out of the
+	 * receive buffer, and populates errorMessage[0] is an error occurs
+	 * 
+	 * @param packet View of a TFTP DATA packet, limited to the received length
+	 * @param blockNumber Highest block number accepted, ahead of the expected block when windowing
+	 * @param blockSize Negotiated block size (RFC 2348)
+	 * @param errorMessage String[] which is populated with error message if invalid (index 0)
+	 * 
+	 * @return Returns true if DATA packet matches TFTP specifications
+	 */
+	public static boolean verifyDataPacket(ByteBuffer packet, int blockNumber, int blockSize, String[] errorMessage)
+	{
+		assert((blockNumber >= 0) && (blockNumber <= MAX_BLOCK_NUMBER));
+
+		int dataLength = packet.limit();
+
+		// Check if the data packet is a valid size
+		if (dataLength < OP_CODE_SIZE + BLOCK_NUMBER_SIZE)
+		{
+			errorMessage[0] = "Something is wrong with the packet";
+			return false;
+		}
+		if (dataLength > OP_CODE_SIZE + BLOCK_NUMBER_SIZE + blockSize)
+		{
+			errorMessage[0] = "Packet too large";
+			return false;
+		}
+
+		// Check if first byte is 0
+		if (packet.get(0) != 0)
+		{
+			errorMessage[0] = "First byte is not 0";
+			return false;
+		}
+
+		// Check if next byte is OPCODE_DATA
+		if (packet.get(1) != DATA_OP_CODE)
+		{
+			errorMessage[0] = "Invalid op code";
+			return false;
+		}
+
+		// Check if block number is larger than the currently 
+		if (getBlockNumber(packet) > blockNumber)
+		{
+			errorMessage[0] = "Invalid block number";
+			return false;
+		}
+
+		return true;
+	}
+
 	/**
 	 * Verify validity of ACK PACKET and populates errorMessage[0] is an error occurs
 	 * 
@@ -987,7 +1176,62 @@ public class TFTP {
 		System.arraycopy(buf,modeStartIndex,mbytes,0,modeLength);
 		m = new String(mbytes).trim();
 
-		return new Request(t, f, m);
+		return new Request(t, f, m, parseOptions(p));
+	}
+
+	/**
+	 * Gets the options (RFC 2347) that follow the mode of a request packet. Option names
+	 * are case insensitive and are returned in lower case.
+	 *
+	 * @param packet A valid TFTP RRQ or WRQ packet
+	 *
+	 * @return Map of option names to values, in the order they appear in the request
+	 */
+	public static Map<String, String> parseOptions(DatagramPacket packet) {
+		byte[] data = packet.getData();
+		int len = packet.getLength();
+		int position = OP_CODE_SIZE;
+
+		// Skip file name and mode
+		for (int i = 0; i < 2; i++) {
+			while (position < len && data[position] != 0) position++;
+			position++;
+		}
+
+		return parseOptions(data, position, len);
+	}
+
+	/**
+	 * Gets the options (RFC 2347) a server acknowledged in an OACK packet, names in
+	 * lower case.
+	 *
+	 * @param packet An OACK packet
+	 *
+	 * @return Map of option names to values, in the order they appear in the OACK
+	 */
+	public static Map<String, String> parseOACK(DatagramPacket packet) {
+		return parseOptions(packet.getData(), OP_CODE_SIZE, packet.getLength());
+	}
+
+	private static Map<String, String> parseOptions(byte[] data, int position, int len) {
+		Map<String, String> options = new LinkedHashMap<String, String>();
+
+		while (position < len) {
+			int nameStart = position;
+			while (position < len && data[position] != 0) position++;
+			String name = new String(data, nameStart, position - nameStart).toLowerCase();
+			position++;
+
+			int valueStart = position;
+			while (position < len && data[position] != 0) position++;
+			if (position >= len) break;
+			String value = new String(data, valueStart, position - valueStart);
+			position++;
+
+			options.put(name, value);
+		}
+
+		return options;
 	}
 
 	/**
@@ -1,36 +1,46 @@
 package code;
 
-import java.awt.Color;
-import java.awt.Graphics;
-import java.awt.image.BufferedImage;
-import java.io.ByteArrayInputStream;
 import java.io.IOException;
 import java.io.InterruptedIOException;
 import java.net.DatagramPacket;
 import java.net.DatagramSocket;
 import java.net.InetAddress;
-import java.net.SocketTimeoutException;
-import java.text.DateFormat;
-import java.text.SimpleDateFormat;
-import java.util.Calendar;
-
-import javax.imageio.ImageIO;
+import java.util.Set;
+import java.util.concurrent.ArrayBlockingQueue;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.ThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
 
 public class TFTPServer extends Thread {
 	private static int RECEIVE_PORT = 69;
 	private static int TIMEOUT = 2000; 	//Maximum time to wait for response before timeout and re-send packet: 2 seconds (2000ms)
-	private static int RESEND_LIMIT = 3; //Maximum number of times to try re-send packet without response: 3
+	static int RESEND_LIMIT = 3; //Maximum number of times to try re-send packet without response: 3
+	private static int MAX_TRANSFERS = 64;	//Transfers served at the same time, one worker thread each
+	private static int MAX_PENDING = 64;	//Requests waiting for a free worker before new ones are refused
 	private DatagramSocket receiveSocket;
-	private boolean verbose = true;
+	private boolean verbose = false;	//Per-packet logging from every worker slows all transfers down
+	private ThreadPoolExecutor workers;
+	private Set<String> activeTransfers = ConcurrentHashMap.newKeySet();
 	
 	public TFTPServer() throws IOException {
+		this(RECEIVE_PORT);
+	}
+
+	// On another port, e.g. for load tests without the rights to bind port 69
+	public TFTPServer(int port) throws IOException {
 		try {
-			receiveSocket = new DatagramSocket(RECEIVE_PORT);
+			receiveSocket = new DatagramSocket(port);
 			receiveSocket.setSoTimeout(5000);
 		} catch(Exception e) {
 			e.printStackTrace();
 			System.exit(1);
 		}
+
+		workers = new ThreadPoolExecutor(MAX_TRANSFERS, MAX_TRANSFERS,
+				60, TimeUnit.SECONDS,
+				new ArrayBlockingQueue<Runnable>(MAX_PENDING));
+		workers.allowCoreThreadTimeOut(true);
 	}
 
 	public void run() {
@@ -45,7 +55,7 @@ public class TFTPServer extends Thread {
 				//if (verbose) System.out.println("Waiting for request from client...");
 				receiveSocket.receive(packet);
 				TFTP.shrinkData(packet);
-				System.out.println("A request was received.");
+				if (verbose) System.out.println("A request was received.");
 			} catch(Exception e) {
 				if (e instanceof InterruptedIOException) {
 					//System.out.println("Socket timeout.");
@@ -56,17 +66,36 @@ public class TFTPServer extends Thread {
 				}
 			}
 
-			// Start a handler to connect with client
+			// Start a handler to connect with client, the listener only
+			// dispatches so requests from other cameras are never held up
 			handleConnection(packet);
 		}
 	}
+
+	static String transferKey(InetAddress addr, int port) {
+		return addr.getHostAddress() + ":" + port;
+	}
+
+	// Called by a transfer once its socket is closed
+	void transferDone(WriteTransfer transfer) {
+		activeTransfers.remove(transfer.getKey());
+	}
+
+	public int getActiveTransfers() {
+		return activeTransfers.size();
+	}
 	
 	public void handleConnection(DatagramPacket packet) {
 		InetAddress replyAddr = packet.getAddress();
 		int TID = packet.getPort();
 		DatagramPacket initialPacket = packet;
 		DatagramSocket socket = null;
-		
+
+		// A re-sent request of a transfer that is already being served
+		if (activeTransfers.contains(transferKey(replyAddr, TID))) {
+			return;
+		}
+
 		try {
 			socket = new DatagramSocket();
 
@@ -103,151 +132,42 @@ public class TFTPServer extends Thread {
 		switch (r.getType()) {
 		case READ:
 			// unsupported
+			socket.close();
 			break;
 		case WRITE:
 			handleWrite(r, replyAddr, TID, socket);
 			break;
-		default: break;
+		default:
+			socket.close();
+			break;
 		}
-		
 	}
 
 	private void handleWrite(Request r, InetAddress replyAddr, int TID, DatagramSocket socket) {
-		try {
-			String fileName = r.getFileName();
-			int currentBlockNumber = 1;
-			DatagramPacket receivePacket;
-			byte[] fileBytes = new byte[0];
-
-			boolean packetInOrder;
-
-			// Form and send ACK0
-			DatagramPacket ackPacket = TFTP.formACKPacket(replyAddr, TID, 0);
-			if (verbose) System.out.println("Sending ACK 0.");
-			socket.send(ackPacket);
-
-			// Flag set when transfer is finished
-			boolean transferComplete = false;
-
-			do {
-				// Wait for a DATA packet
-				if (verbose) System.out.println("Waiting for DATA from client...");
-				receivePacket = TFTP.formPacket();
-
-				for(int i = 0; i<RESEND_LIMIT+1; i++) {
-					try {
-						socket.receive(receivePacket);
-						break;		//If packet successfully received, leave loop
-					} catch(SocketTimeoutException e) {
-						//if re-send attempt limit reached, 'give up' and cancel transfer
-						if(i == RESEND_LIMIT) {
-							System.out.println("No response from client after " + RESEND_LIMIT + " attempts. Try again later.");
-							socket.close();
-							return;
-						}
-					}
-				}
-
-
-				TFTP.shrinkData(receivePacket);
-
-				InetAddress packetAddress = receivePacket.getAddress();
-				int packetPort = receivePacket.getPort();
-				if (!(packetAddress.equals(replyAddr) && (packetPort == TID))) {
-					// Creates an "unknown TID" error packet
-					DatagramPacket errorPacket = TFTP.formERRORPacket(
-							packetAddress,
-							packetPort,
-							TFTP.ERROR_CODE_UNKNOWN_TID,
-							"The address and port of the packet does not match the TID of the ongoing transfer.");
-
-					// Sends error packet
-					socket.send(errorPacket);
-
-					// Echo error message
-					if (verbose) System.out.println("Sent ERROR packet with ERROR code " + TFTP.getErrorCode(errorPacket) + ": Received packet from an unknown host. Discarding packet and continuing transfer...\n");
-					continue;
-				}
-
-				// This block is entered if the packet received is not a valid DATA packet
-				String[] errorMessage = new String[1];
-				if (!TFTP.verifyDataPacket(receivePacket, currentBlockNumber, errorMessage)) {
-					// If an ERROR packet is received instead of the expected DATA packet, delete the file
-					// and abort the transfer
-					String[] errorMessage2 = new String[1];
-					if (TFTP.verifyErrorPacket(receivePacket, errorMessage2)) {
-						if (verbose) System.out.println("Received ERROR packet with ERROR code " + TFTP.getErrorCode(receivePacket) + ": " + TFTP.getErrorMessage(receivePacket) + ". Aborting transfer...\n");
-						return;
-					}
-					// If the received packet is not a DATA or an ERROR packet, then send an illegal TFTP
-					// operation ERROR packet and abort the transfer
-					else {
-						// Creates an "illegal TFTP operation" error packet
-						DatagramPacket errorPacket = TFTP.formERRORPacket(
-								replyAddr,
-								TID,
-								TFTP.ERROR_CODE_ILLEGAL_TFTP_OPERATION,
-								fileName + " could not be transferred because of the following error: " + errorMessage[0] + " (server expected a DATA packet with block#: " + currentBlockNumber + ")");
-
-						// Sends error packet
-						socket.send(errorPacket);
-
-						// Echo error message
-						if (verbose) System.out.println("Sent ERROR packet with ERROR code " + TFTP.getErrorCode(errorPacket) + ": Illegal TFTP Operation. Aborting transfer...\n");
-						return;
-					}
-				}
-
-				// Transfer is complete if data block is less than MAX_DATA_SIZE
-				if (receivePacket.getLength() < TFTP.MAX_PACKET_SIZE) {
-					transferComplete = true;
-				}
+		WriteTransfer transfer = new WriteTransfer(this, r, replyAddr, TID, socket, verbose);
 
-				// Echo successful data receive
-				if (verbose) System.out.println("DATA " + TFTP.getBlockNumber(receivePacket) + " received.");
-				// Newline
-				if (verbose) System.out.println();
-
-				packetInOrder = TFTP.checkPacketInOrder(receivePacket, currentBlockNumber);
-
-				//If the packet was the correct next sequential packet in the transfer (not delayed/duplicated)
-				if(packetInOrder){
-					// Write the data packet to file
-					fileBytes = TFTP.appendData(receivePacket, fileBytes);
-				}
-
-				// Form a ACK packet to respond with
-				ackPacket = TFTP.formACKPacket(replyAddr, TID, TFTP.getBlockNumber(receivePacket));
-				if (verbose) System.out.println("Sending ACK " + TFTP.getBlockNumber(ackPacket) + ".");
-				socket.send(ackPacket);
-
-				//Increment next block number expected only if the last packet received was the correct sequentially expected one 
-				if(packetInOrder){
-					currentBlockNumber = (currentBlockNumber + 1) % (TFTP.MAX_BLOCK_NUMBER + 1);
-				}
-
-			} while (!transferComplete);
+		activeTransfers.add(transfer.getKey());
+		try {
+			workers.execute(transfer);
+		} catch (RejectedExecutionException e) {
+			activeTransfers.remove(transfer.getKey());
 
-			// Create image
-			BufferedImage img = ImageIO.read(new ByteArrayInputStream(fileBytes));
-
-			// Add time to the image
-			DateFormat dateFormat = new SimpleDateFormat("yyyy/MM/dd HH:mm:ss");
-			Calendar cal = Calendar.getInstance();
-			Graphics g = img.getGraphics();
-			g.setFont(g.getFont().deriveFont(15f));
-			g.setColor(Color.RED);
-			g.drawString(dateFormat.format(cal.getTime()), 30, 30);
-			g.dispose();
-
-			// Add img to the shared list
-			Start.getImgList().add(img);
-			System.out.print("Added one img to list!\n");
-		} catch(Exception e) {
-			System.out.println(e.getMessage());
+			// Refuse instead of letting the camera time out on a full queue
+			DatagramPacket errorPacket = TFTP.formERRORPacket(
+					replyAddr,
+					TID,
+					TFTP.ERROR_CODE_NOT_DEFINED,
+					"Server busy, try again later.");
+			try {
+				socket.send(errorPacket);
+			} catch (IOException e2) {
+				e2.printStackTrace();
+			}
+			socket.close();
+			System.out.println("Refused request from " + transfer.getKey() + ": too many transfers.");
 		}
 	}
-	
+
 	/*private void handleWrite(Request r, InetAddress replyAddr, int TID, DatagramSocket socket) {
 		try {
 			String fileName = r.getFileName();
@@ -0,0 +1,268 @@
+package code;
+
+import java.io.IOException;
+import java.net.DatagramPacket;
+import java.net.DatagramSocket;
+import java.net.InetAddress;
+import java.net.SocketTimeoutException;
+import java.nio.ByteBuffer;
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+// State of one write request, run on a worker thread of the server. Each
+// transfer has its own socket (TID), so a slow camera only blocks its own
+// worker. Block size, transfer size and window size are negotiated with the
+// client (RFC 2347/2348/2349/7440) when it asks for them. Packets are
+// received into pooled buffers and parsed in place, and their data is
+// written straight into a pooled frame buffer.
+public class WriteTransfer implements Runnable {
+	private static int MAX_PREALLOCATE = 1024 * 1024;	//Largest tsize that is trusted for preallocation
+	private static int RECEIVE_BUFFER_SIZE = TFTP.OP_CODE_SIZE + TFTP.BLOCK_NUMBER_SIZE + TFTP.MAX_BLKSIZE + 1;
+	private static BufferPool<byte[]> receiveBuffers = new BufferPool<byte[]>(() -> new byte[RECEIVE_BUFFER_SIZE]);
+	private TFTPServer server;
+	private Request request;
+	private InetAddress replyAddr;
+	private int TID;
+	private DatagramSocket socket;
+	private boolean verbose;
+	private int currentBlockNumber = 1;
+	private int blockSize = TFTP.MAX_DATA_SIZE;
+	private int windowSize = 1;
+	private long transferSize = -1;
+	private FrameBuffer fileBytes;
+	private FrameTiming timing;
+
+	public WriteTransfer(TFTPServer server, Request request, InetAddress replyAddr, int TID, DatagramSocket socket, boolean verbose) {
+		timing = new FrameTiming(System.nanoTime());	//Made as the WRQ arrives
+		this.server = server;
+		this.request = request;
+		this.replyAddr = replyAddr;
+		this.TID = TID;
+		this.socket = socket;
+		this.verbose = verbose;
+	}
+
+	public String getKey() {
+		return TFTPServer.transferKey(replyAddr, TID);
+	}
+
+	public void run() {
+		long startTime = System.nanoTime();
+
+		try {
+			if (receiveFile()) {
+				timing.lastBlock = System.nanoTime();
+				long elapsedMs = Math.max((System.nanoTime() - startTime) / 1000000, 1);
+				System.out.println(request.getFileName() + " from " + getKey() + ": " + fileBytes.getLength() + " bytes in " + elapsedMs + " ms ("
+						+ (fileBytes.getLength() / elapsedMs) + " KB/s), blksize " + blockSize + ", windowsize " + windowSize);
+				FrameSink.deliver(CameraRegistry.cameraId(replyAddr, request.getFileName()), fileBytes, timing, verbose);
+			}
+		} catch(Exception e) {
+			System.out.println(e.getMessage());
+		} finally {
+			if (fileBytes != null) {
+				FrameSink.frameBuffers.release(fileBytes);
+			}
+			socket.close();
+			server.transferDone(this);
+		}
+	}
+
+	// Accepts the supported options of the request, returns the ones to acknowledge in an OACK
+	private Map<String, String> negotiateOptions() {
+		Map<String, String> accepted = new LinkedHashMap<String, String>();
+
+		for (Map.Entry<String, String> option : request.getOptions().entrySet()) {
+			long value;
+			try {
+				value = Long.parseLong(option.getValue());
+			} catch (NumberFormatException e) {
+				continue;	//Options with bad values are ignored, not refused
+			}
+
+			switch (option.getKey()) {
+			case TFTP.OPTION_BLKSIZE:
+				if (value < TFTP.MIN_BLKSIZE) continue;
+				blockSize = (int)Math.min(value, TFTP.MAX_BLKSIZE);
+				accepted.put(TFTP.OPTION_BLKSIZE, Integer.toString(blockSize));
+				break;
+			case TFTP.OPTION_TSIZE:
+				if (value < 0) continue;
+				transferSize = value;
+				accepted.put(TFTP.OPTION_TSIZE, Long.toString(transferSize));
+				break;
+			case TFTP.OPTION_WINDOWSIZE:
+				if (value < 1) continue;
+				windowSize = (int)Math.min(value, TFTP.MAX_WINDOWSIZE);
+				accepted.put(TFTP.OPTION_WINDOWSIZE, Integer.toString(windowSize));
+				break;
+			default: break;
+			}
+		}
+
+		return accepted;
+	}
+
+	// Receives the DATA blocks, a window of windowSize blocks per ACK. Returns true once the last block was acknowledged
+	private boolean receiveFile() throws IOException {
+		byte[] receiveBuffer = receiveBuffers.acquire();
+		try {
+			return receiveFile(receiveBuffer);
+		} finally {
+			receiveBuffers.release(receiveBuffer);
+		}
+	}
+
+	private boolean receiveFile(byte[] receiveBuffer) throws IOException {
+		String fileName = request.getFileName();
+		String[] errorMessage = new String[1];
+		boolean packetInOrder;
+		int windowCount = 0;
+
+		Map<String, String> acceptedOptions = negotiateOptions();
+		timing.setFromOptions(request.getOptions());	//Not acknowledged, the camera does not need them back
+
+		// The announced size saves growing the buffer while receiving
+		fileBytes = FrameSink.frameBuffers.acquire();
+		fileBytes.reset((transferSize >= 0 && transferSize <= MAX_PREALLOCATE) ? (int)transferSize : FrameSink.DEFAULT_FILE_SIZE);
+
+		// One packet and view of the receive buffer for the whole transfer, the header is
+		// read in place and the data copied once, into the frame
+		int receiveLength = TFTP.OP_CODE_SIZE + TFTP.BLOCK_NUMBER_SIZE + blockSize + 1;
+		DatagramPacket receivePacket = new DatagramPacket(receiveBuffer, receiveLength);
+		ByteBuffer receiveView = ByteBuffer.wrap(receiveBuffer);
+
+		// ACKs of DATA blocks only differ in their block number
+		DatagramPacket blockAckPacket = TFTP.formACKPacket(replyAddr, TID, 0);
+		DatagramPacket ackPacket;
+
+		if (acceptedOptions.isEmpty()) {
+			// Form and send ACK0
+			ackPacket = blockAckPacket;
+			if (verbose) System.out.println("Sending ACK 0.");
+		} else {
+			// Options are acknowledged in place of ACK0
+			ackPacket = TFTP.formOACKPacket(replyAddr, TID, acceptedOptions);
+			if (verbose) System.out.println("Sending OACK " + acceptedOptions + ".");
+		}
+		socket.send(ackPacket);
+
+		// Flag set when transfer is finished
+		boolean transferComplete = false;
+
+		do {
+			// Wait for a DATA packet
+			if (verbose) System.out.println("Waiting for DATA from client...");
+			receivePacket.setLength(receiveLength);
+
+			for(int i = 0; i<TFTPServer.RESEND_LIMIT+1; i++) {
+				try {
+					socket.receive(receivePacket);
+					break;		//If packet successfully received, leave loop
+				} catch(SocketTimeoutException e) {
+					//if re-send attempt limit reached, 'give up' and cancel transfer
+					if(i == TFTPServer.RESEND_LIMIT) {
+						System.out.println("No response from client after " + TFTPServer.RESEND_LIMIT + " attempts. Try again later.");
+						return false;
+					}
+					// Re-send the last ACK in case it was lost
+					socket.send(ackPacket);
+				}
+			}
+
+			receiveView.clear();
+			receiveView.limit(receivePacket.getLength());
+
+			InetAddress packetAddress = receivePacket.getAddress();
+			int packetPort = receivePacket.getPort();
+			if (!(packetAddress.equals(replyAddr) && (packetPort == TID))) {
+				// Creates an "unknown TID" error packet
+				DatagramPacket errorPacket = TFTP.formERRORPacket(
+						packetAddress,
+						packetPort,
+						TFTP.ERROR_CODE_UNKNOWN_TID,
+						"The address and port of the packet does not match the TID of the ongoing transfer.");
+
+				// Sends error packet
+				socket.send(errorPacket);
+
+				// Echo error message
+				if (verbose) System.out.println("Sent ERROR packet with ERROR code " + TFTP.getErrorCode(errorPacket) + ": Received packet from an unknown host. Discarding packet and continuing transfer...\n");
+				continue;
+			}
+
+			// This block is entered if the packet received is not a valid DATA packet
+			int lastWindowBlockNumber = (currentBlockNumber + windowSize - 1) % (TFTP.MAX_BLOCK_NUMBER + 1);
+			if (!TFTP.verifyDataPacket(receiveView, lastWindowBlockNumber, blockSize, errorMessage)) {
+				// Not worth parsing in place, the transfer ends here
+				TFTP.shrinkData(receivePacket);
+
+				// If an ERROR packet is received instead of the expected DATA packet, abort the transfer
+				String[] errorMessage2 = new String[1];
+				if (TFTP.verifyErrorPacket(receivePacket, errorMessage2)) {
+					if (verbose) System.out.println("Received ERROR packet with ERROR code " + TFTP.getErrorCode(receivePacket) + ": " + TFTP.getErrorMessage(receivePacket) + ". Aborting transfer...\n");
+					return false;
+				}
+				// If the received packet is not a DATA or an ERROR packet, then send an illegal TFTP
+				// operation ERROR packet and abort the transfer
+				else {
+					// Creates an "illegal TFTP operation" error packet
+					DatagramPacket errorPacket = TFTP.formERRORPacket(
+							replyAddr,
+							TID,
+							TFTP.ERROR_CODE_ILLEGAL_TFTP_OPERATION,
+							fileName + " could not be transferred because of the following error: " + errorMessage[0] + " (server expected a DATA packet with block#: " + currentBlockNumber + ")");
+
+					// Sends error packet
+					socket.send(errorPacket);
+
+					// Echo error message
+					if (verbose) System.out.println("Sent ERROR packet with ERROR code " + TFTP.getErrorCode(errorPacket) + ": Illegal TFTP Operation. Aborting transfer...\n");
+					return false;
+				}
+			}
+
+			// Echo successful data receive
+			if (verbose) System.out.println("DATA " + TFTP.getBlockNumber(receiveView) + " received.");
+
+			packetInOrder = TFTP.getBlockNumber(receiveView) == currentBlockNumber;
+
+			//If the packet was the correct next sequential packet in the transfer (not delayed/duplicated)
+			if(packetInOrder){
+				// Write the data packet to file
+				int dataLength = receivePacket.getLength() - TFTP.OP_CODE_SIZE - TFTP.BLOCK_NUMBER_SIZE;
+				fileBytes.write(receiveBuffer, TFTP.OP_CODE_SIZE + TFTP.BLOCK_NUMBER_SIZE, dataLength);
+
+				// Transfer is complete if data block is less than the block size
+				if (dataLength < blockSize) {
+					transferComplete = true;
+				}
+
+				// One ACK per window, and for the last block
+				windowCount++;
+				if (windowCount == windowSize || transferComplete) {
+					ackPacket = blockAckPacket;
+					TFTP.setBlockNumber(ackPacket, currentBlockNumber);
+					if (verbose) System.out.println("Sending ACK " + currentBlockNumber + ".");
+					socket.send(ackPacket);
+					windowCount = 0;
+				}
+
+				currentBlockNumber = (currentBlockNumber + 1) % (TFTP.MAX_BLOCK_NUMBER + 1);
+			} else {
+				// A block of the window was lost, or an acknowledged block was sent again. ACK the
+				// last block received in order so the client carries on after it
+				int lastBlockNumber = (currentBlockNumber + TFTP.MAX_BLOCK_NUMBER) % (TFTP.MAX_BLOCK_NUMBER + 1);
+				ackPacket = blockAckPacket;
+				TFTP.setBlockNumber(ackPacket, lastBlockNumber);
+				if (verbose) System.out.println("Sending ACK " + lastBlockNumber + ".");
+				socket.send(ackPacket);
+				windowCount = 0;
+			}
+
+		} while (!transferComplete);
+
+		return true;
+	}
+
+}
@@ -0,0 +1,119 @@
+package test;
+
+import java.lang.management.ManagementFactory;
+import java.net.DatagramPacket;
+import java.nio.ByteBuffer;
+
+import code.FrameBuffer;
+import code.TFTP;
+
+// Compares assembling a frame from 512 byte DATA blocks the old way (new
+// packet per block, shrinkData() and appendData()) against receiving into
+// one reused buffer parsed in place and written into a FrameBuffer. Run on
+// a HotSpot JVM, which reports the bytes allocated per thread.
+public class AssemblyBenchmark {
+	private static final int[] FRAME_SIZES = {20 * 1024, 100 * 1024, 1024 * 1024};
+	private static final int BLOCK_SIZE = TFTP.MAX_DATA_SIZE;
+	private static final int HEADER_SIZE = TFTP.OP_CODE_SIZE + TFTP.BLOCK_NUMBER_SIZE;
+	private static final long RUN_NANOS = 2000000000L;
+
+	private static com.sun.management.ThreadMXBean threads =
+			(com.sun.management.ThreadMXBean)ManagementFactory.getThreadMXBean();
+	private static long sink;
+
+	public static void main(String[] args) {
+		System.out.println("frame_bytes path frames us_per_frame bytes_allocated_per_frame");
+		for (int frameSize : FRAME_SIZES) {
+			byte[] frame = new byte[frameSize];
+			for (int i = 0; i < frame.length; i++) frame[i] = (byte)i;
+
+			// Warm up both paths before measuring
+			measure(frame, false, RUN_NANOS / 4, null);
+			measure(frame, true, RUN_NANOS / 4, null);
+
+			measure(frame, false, RUN_NANOS, "copy");
+			measure(frame, true, RUN_NANOS, "inplace");
+		}
+		if (sink == 42) System.out.println();
+	}
+
+	private static void measure(byte[] frame, boolean inPlace, long runNanos, String name) {
+		long threadId = Thread.currentThread().getId();
+		int frames = 0;
+		long startBytes = threads.getThreadAllocatedBytes(threadId);
+		long start = System.nanoTime();
+		long elapsed;
+
+		FrameBuffer frameBuffer = new FrameBuffer(frame.length);
+		byte[] receiveBuffer = new byte[HEADER_SIZE + TFTP.MAX_BLKSIZE + 1];
+		DatagramPacket receivePacket = new DatagramPacket(receiveBuffer, receiveBuffer.length);
+		ByteBuffer receiveView = ByteBuffer.wrap(receiveBuffer);
+
+		do {
+			if (inPlace) {
+				sink += assembleInPlace(frame, frameBuffer, receivePacket, receiveView);
+			} else {
+				sink += assembleCopy(frame);
+			}
+			frames++;
+			elapsed = System.nanoTime() - start;
+		} while (elapsed < runNanos);
+
+		long bytes = threads.getThreadAllocatedBytes(threadId) - startBytes;
+		if (name != null) {
+			System.out.println(frame.length + " " + name + " " + frames + " "
+					+ (elapsed / 1000 / frames) + " " + (bytes / frames));
+		}
+	}
+
+	// What a socket receive leaves in the packet's buffer
+	private static int receiveBlock(byte[] frame, int blockNumber, byte[] buf) {
+		int offset = (blockNumber - 1) * BLOCK_SIZE;
+		int length = Math.max(Math.min(BLOCK_SIZE, frame.length - offset), 0);
+		buf[0] = 0;
+		buf[1] = TFTP.DATA_OP_CODE;
+		buf[2] = (byte)(blockNumber >> 8);
+		buf[3] = (byte)blockNumber;
+		System.arraycopy(frame, offset, buf, HEADER_SIZE, length);
+		return HEADER_SIZE + length;
+	}
+
+	private static int assembleCopy(byte[] frame) {
+		byte[] fileBytes = new byte[0];
+		int blockNumber = 1;
+		boolean complete = false;
+
+		while (!complete) {
+			DatagramPacket packet = TFTP.formPacket();
+			packet.setLength(receiveBlock(frame, blockNumber, packet.getData()));
+			TFTP.shrinkData(packet);
+			complete = packet.getLength() < TFTP.MAX_PACKET_SIZE;
+			if (TFTP.checkPacketInOrder(packet, blockNumber)) {
+				fileBytes = TFTP.appendData(packet, fileBytes);
+			}
+			blockNumber++;
+		}
+
+		return fileBytes.length;
+	}
+
+	private static int assembleInPlace(byte[] frame, FrameBuffer frameBuffer, DatagramPacket packet, ByteBuffer view) {
+		int blockNumber = 1;
+		boolean complete = false;
+
+		frameBuffer.reset(frame.length);
+		while (!complete) {
+			packet.setLength(receiveBlock(frame, blockNumber, packet.getData()));
+			view.clear();
+			view.limit(packet.getLength());
+			int dataLength = view.limit() - HEADER_SIZE;
+			complete = dataLength < BLOCK_SIZE;
+			if (TFTP.getBlockNumber(view) == (blockNumber & 0xFFFF)) {
+				frameBuffer.write(packet.getData(), HEADER_SIZE, dataLength);
+			}
+			blockNumber++;
+		}
+
+		return frameBuffer.getLength();
+	}
+}
@@ -0,0 +1,401 @@
+package test;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.PrintStream;
+import java.net.DatagramPacket;
+import java.net.DatagramSocket;
+import java.net.InetAddress;
+import java.net.SocketTimeoutException;
+import java.nio.file.Files;
+import java.nio.file.Paths;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Locale;
+import java.util.Random;
+import java.util.concurrent.atomic.AtomicLong;
+
+import code.LatencyHistogram;
+import code.Start;
+import code.TFTP;
+import code.TFTPServer;
+
+// Load test of the TFTP ingest path. Simulates cameras that each upload a
+// JPEG with a write request at a fixed frame rate, the way the firmware
+// does, over loopback. Outgoing DATA blocks can be dropped or swapped with
+// the next one, and incoming ACKs dropped, to see how the server copes with
+// a lossy link. Prints one JSON object with the results on stdout.
+//
+//   LoadGenerator [-cameras n] [-fps f] [-seconds s] [-size bytes | -image file.jpg]
+//                 [-blksize b] [-windowsize w] [-loss p] [-reorder p] [-seed n]
+//                 [-host h] [-port p] [-inprocess [-record]]
+//
+// -inprocess runs a TFTPServer in this JVM on -port (6969 by default), so
+// no rights to bind port 69 are needed. It neither records nor saves clips
+// unless -record is given. The server's own output goes to stderr.
+public class LoadGenerator {
+	private static int RETRANSMIT_TIMEOUT = 500;	//ms before a window or request is sent again
+	private static int MAX_RETRIES = 5;	//Timeouts in a row before a transfer is given up
+	private static int IN_PROCESS_PORT = 6969;
+	private static String BUSY_MESSAGE = "Server busy";	//Start of the server's refusal
+
+	// Settings
+	private static int cameras = 4;
+	private static double fps = 5;
+	private static int seconds = 10;
+	private static int frameSize = 20 * 1024;
+	private static String imagePath;
+	private static int blockSize = TFTP.MAX_DATA_SIZE;
+	private static int windowSize = 1;
+	private static double loss;
+	private static double reorder;
+	private static long seed = 1;
+	private static String host = "localhost";
+	private static int port = -1;
+	private static boolean inProcess;
+	private static boolean record;
+
+	// Results, from all cameras
+	private static AtomicLong attempted = new AtomicLong();
+	private static AtomicLong completed = new AtomicLong();
+	private static AtomicLong skipped = new AtomicLong();	//Frame times missed while the previous frame was still being sent
+	private static AtomicLong timeouts = new AtomicLong();
+	private static AtomicLong refused = new AtomicLong();
+	private static AtomicLong errors = new AtomicLong();
+	private static AtomicLong retransmits = new AtomicLong();
+	private static AtomicLong bytes = new AtomicLong();
+	private static LatencyHistogram latency = new LatencyHistogram();	//WRQ sent to last ACK
+
+	public static void main(String[] args) throws Exception {
+		if (!parseArgs(args)) {
+			System.err.println("Usage: LoadGenerator [-cameras n] [-fps f] [-seconds s] [-size bytes | -image file.jpg]");
+			System.err.println("                     [-blksize b] [-windowsize w] [-loss p] [-reorder p] [-seed n]");
+			System.err.println("                     [-host h] [-port p] [-inprocess [-record]]");
+			System.exit(2);
+		}
+
+		byte[] frame = imagePath != null ? Files.readAllBytes(Paths.get(imagePath)) : syntheticFrame(frameSize, seed);
+		PrintStream results = System.out;
+		if (inProcess) {
+			System.setOut(System.err);
+			if (port < 0) port = IN_PROCESS_PORT;
+			if (record) {
+				Start.startRecording();
+			} else {
+				Start.clips = null;
+			}
+			TFTPServer server = new TFTPServer(port);
+			server.setDaemon(true);
+			server.start();
+		} else if (port < 0) {
+			port = 69;
+		}
+		InetAddress address = InetAddress.getByName(host);
+
+		long start = System.nanoTime();
+		long end = start + seconds * 1000000000L;
+		List<Thread> threads = new ArrayList<Thread>();
+		for (int i = 0; i < cameras; i++) {
+			int camera = i;
+			Thread thread = new Thread(() -> runCamera(camera, address, frame, end), "camera-" + i);
+			threads.add(thread);
+			thread.start();
+		}
+		for (Thread thread : threads) {
+			thread.join();
+		}
+		double elapsed = (System.nanoTime() - start) / 1e9;
+
+		results.println(toJson(frame.length, elapsed));
+		System.exit(0);
+	}
+
+	private static boolean parseArgs(String[] args) {
+		try {
+			for (int i = 0; i < args.length; i++) {
+				switch (args[i]) {
+				case "-cameras": cameras = Integer.parseInt(args[++i]); break;
+				case "-fps": fps = Double.parseDouble(args[++i]); break;
+				case "-seconds": seconds = Integer.parseInt(args[++i]); break;
+				case "-size": frameSize = Integer.parseInt(args[++i]); break;
+				case "-image": imagePath = args[++i]; break;
+				case "-blksize": blockSize = Integer.parseInt(args[++i]); break;
+				case "-windowsize": windowSize = Integer.parseInt(args[++i]); break;
+				case "-loss": loss = Double.parseDouble(args[++i]); break;
+				case "-reorder": reorder = Double.parseDouble(args[++i]); break;
+				case "-seed": seed = Long.parseLong(args[++i]); break;
+				case "-host": host = args[++i]; break;
+				case "-port": port = Integer.parseInt(args[++i]); break;
+				case "-inprocess": inProcess = true; break;
+				case "-record": record = true; break;
+				default: return false;
+				}
+			}
+		} catch (NumberFormatException | ArrayIndexOutOfBoundsException e) {
+			return false;
+		}
+		return cameras > 0 && fps > 0 && seconds > 0 && frameSize > 0
+				&& blockSize >= TFTP.MIN_BLKSIZE && blockSize <= TFTP.MAX_BLKSIZE
+				&& windowSize >= 1 && windowSize <= TFTP.MAX_WINDOWSIZE;
+	}
+
+	// Random bytes between JPEG start and end markers, the server only needs them to arrive
+	private static byte[] syntheticFrame(int size, long seed) {
+		byte[] frame = new byte[Math.max(size, 4)];
+		new Random(seed).nextBytes(frame);
+		frame[0] = (byte)0xFF;
+		frame[1] = (byte)0xD8;
+		frame[frame.length - 2] = (byte)0xFF;
+		frame[frame.length - 1] = (byte)0xD9;
+		return frame;
+	}
+
+	// One camera: a frame every 1/fps seconds, skipping frame times while a transfer runs late
+	private static void runCamera(int camera, InetAddress address, byte[] frame, long end) {
+		Random random = new Random(seed + camera);
+		long period = (long)(1000000000L / fps);
+		long next = System.nanoTime() + (long)(random.nextDouble() * period);	//Spread the cameras out
+		int seq = 0;
+
+		while (true) {
+			long now = System.nanoTime();
+			if (next >= end) {
+				break;
+			}
+			if (now < next) {
+				sleepNanos(next - now);
+			}
+
+			attempted.incrementAndGet();
+			long sent = System.nanoTime();
+			if (send(camera, seq++, address, frame, random)) {
+				latency.record((System.nanoTime() - sent) / 1000);
+				completed.incrementAndGet();
+				bytes.addAndGet(frame.length);
+			}
+
+			next += period;
+			now = System.nanoTime();
+			if (now > next) {
+				long missed = (now - next) / period + 1;
+				skipped.addAndGet(missed);
+				next += missed * period;
+			}
+		}
+	}
+
+	// One write request, on a new socket like the camera's. Returns true once the last block is acknowledged
+	private static boolean send(int camera, int seq, InetAddress address, byte[] frame, Random random) {
+		try (DatagramSocket socket = new DatagramSocket()) {
+			socket.setSoTimeout(RETRANSMIT_TIMEOUT);
+			byte[] receiveBuffer = new byte[TFTP.MAX_PACKET_SIZE];
+			DatagramPacket received = new DatagramPacket(receiveBuffer, receiveBuffer.length);
+
+			// Request, until the server answers from its transfer port
+			DatagramPacket request = writeRequest(address, "cam" + camera + ".jpg", frame.length, seq);
+			int serverPort = -1;
+			int blksize = TFTP.MAX_DATA_SIZE;
+			int windowsize = 1;
+			for (int tries = 0; serverPort < 0; tries++) {
+				if (tries > MAX_RETRIES) {
+					timeouts.incrementAndGet();
+					return false;
+				}
+				if (tries > 0) retransmits.incrementAndGet();
+				socket.send(request);
+				if (!receive(socket, received, random)) continue;
+
+				int opCode = opCode(received);
+				if (opCode == TFTP.ERROR_OP_CODE) {
+					return error(received);
+				}
+				if (opCode == TFTP.OACK_OP_CODE) {
+					String[] options = new String(receiveBuffer, 2, received.getLength() - 2).split("\0");
+					for (int i = 0; i + 1 < options.length; i += 2) {
+						if (options[i].equalsIgnoreCase(TFTP.OPTION_BLKSIZE)) blksize = Integer.parseInt(options[i + 1]);
+						if (options[i].equalsIgnoreCase(TFTP.OPTION_WINDOWSIZE)) windowsize = Integer.parseInt(options[i + 1]);
+					}
+				} else if (opCode != TFTP.ACK_OP_CODE || blockNumber(received) != 0) {
+					continue;
+				}
+				serverPort = received.getPort();
+			}
+
+			// Windows of DATA blocks, each acknowledged as a whole. The last block is short, maybe empty.
+			int blocks = frame.length / blksize + 1;
+			int acked = 0;
+			int retries = 0;
+			byte[] data = new byte[TFTP.OP_CODE_SIZE + TFTP.BLOCK_NUMBER_SIZE + blksize];
+			while (acked < blocks) {
+				sendWindow(socket, address, serverPort, frame, blksize, acked, Math.min(acked + windowsize, blocks), data, random);
+
+				// Wait for an ACK that moves the window, a stale one means the server wants the window again
+				boolean moved = false;
+				while (!moved) {
+					if (!receive(socket, received, random)) {
+						if (++retries > MAX_RETRIES) {
+							timeouts.incrementAndGet();
+							return false;
+						}
+						retransmits.incrementAndGet();
+						break;
+					}
+					if (received.getPort() != serverPort) continue;
+					int opCode = opCode(received);
+					if (opCode == TFTP.ERROR_OP_CODE) {
+						return error(received);
+					}
+					if (opCode != TFTP.ACK_OP_CODE) continue;
+
+					int advance = (blockNumber(received) - acked) & 0xFFFF;
+					if (advance > windowsize) continue;	//Older than the window
+					if (advance == 0) {
+						retransmits.incrementAndGet();
+					}
+					acked += advance;
+					retries = 0;
+					moved = true;
+				}
+			}
+			return true;
+		} catch (IOException e) {
+			errors.incrementAndGet();
+			return false;
+		}
+	}
+
+	// Blocks first+1..last, each may be lost, or held back and sent after the next one
+	private static void sendWindow(DatagramSocket socket, InetAddress address, int port, byte[] frame, int blksize,
+			int first, int last, byte[] data, Random random) throws IOException {
+		DatagramPacket held = null;
+		for (int block = first + 1; block <= last; block++) {
+			int offset = (block - 1) * blksize;
+			int length = Math.min(blksize, frame.length - offset);
+			byte[] packet = (held != null) ? new byte[data.length] : data;	//A held packet keeps its buffer
+			packet[0] = 0;
+			packet[1] = TFTP.DATA_OP_CODE;
+			packet[2] = (byte)(block >> 8);
+			packet[3] = (byte)block;
+			System.arraycopy(frame, offset, packet, 4, length);
+			DatagramPacket datagram = new DatagramPacket(packet, 4 + length, address, port);
+
+			if (random.nextDouble() < loss) {
+				continue;
+			}
+			if (held == null && block < last && random.nextDouble() < reorder) {
+				held = datagram;
+				continue;
+			}
+			socket.send(datagram);
+			if (held != null) {
+				socket.send(held);
+				held = null;
+			}
+		}
+		if (held != null) {
+			socket.send(held);
+		}
+	}
+
+	// Receives one packet, false on timeout; received packets may be lost too
+	private static boolean receive(DatagramSocket socket, DatagramPacket packet, Random random) throws IOException {
+		while (true) {
+			packet.setLength(packet.getData().length);
+			try {
+				socket.receive(packet);
+			} catch (SocketTimeoutException e) {
+				return false;
+			}
+			if (random.nextDouble() >= loss) {
+				return true;
+			}
+		}
+	}
+
+	private static boolean error(DatagramPacket packet) {
+		String message = new String(packet.getData(), 4, Math.max(packet.getLength() - 5, 0));
+		if (message.startsWith(BUSY_MESSAGE)) {
+			refused.incrementAndGet();
+		} else {
+			errors.incrementAndGet();
+		}
+		return false;
+	}
+
+	// WRQ with the options the camera sends, see tftp_stream.c
+	private static DatagramPacket writeRequest(InetAddress address, String fileName, int size, int seq) {
+		ByteArrayOutputStream buf = new ByteArrayOutputStream();
+		buf.write(0);
+		buf.write(TFTP.WRITE_OP_CODE);
+		writeString(buf, fileName);
+		writeString(buf, TFTP.MODE_OCTET);
+		writeString(buf, TFTP.OPTION_TSIZE);
+		writeString(buf, Integer.toString(size));
+		if (blockSize != TFTP.MAX_DATA_SIZE) {
+			writeString(buf, TFTP.OPTION_BLKSIZE);
+			writeString(buf, Integer.toString(blockSize));
+		}
+		if (windowSize != 1) {
+			writeString(buf, TFTP.OPTION_WINDOWSIZE);
+			writeString(buf, Integer.toString(windowSize));
+		}
+		writeString(buf, "seq");
+		writeString(buf, Integer.toString(seq));
+		byte[] data = buf.toByteArray();
+		return new DatagramPacket(data, data.length, address, port);
+	}
+
+	private static void writeString(ByteArrayOutputStream buf, String value) {
+		byte[] bytes = value.getBytes();
+		buf.write(bytes, 0, bytes.length);
+		buf.write(0);
+	}
+
+	private static int opCode(DatagramPacket packet) {
+		return packet.getLength() < 2 ? -1 : ((packet.getData()[0] & 0xFF) << 8) | (packet.getData()[1] & 0xFF);
+	}
+
+	private static int blockNumber(DatagramPacket packet) {
+		return packet.getLength() < 4 ? -1 : ((packet.getData()[2] & 0xFF) << 8) | (packet.getData()[3] & 0xFF);
+	}
+
+	private static void sleepNanos(long nanos) {
+		try {
+			Thread.sleep(nanos / 1000000, (int)(nanos % 1000000));
+		} catch (InterruptedException e) {
+			Thread.currentThread().interrupt();
+		}
+	}
+
+	private static String toJson(int frameBytes, double elapsed) {
+		StringBuilder json = new StringBuilder("{");
+		json.append("\"cameras\":").append(cameras);
+		json.append(",\"fps\":").append(format(fps));
+		json.append(",\"frame_bytes\":").append(frameBytes);
+		json.append(",\"blksize\":").append(blockSize);
+		json.append(",\"windowsize\":").append(windowSize);
+		json.append(",\"loss\":").append(format(loss));
+		json.append(",\"reorder\":").append(format(reorder));
+		json.append(",\"seconds\":").append(format(elapsed));
+		json.append(",\"attempted\":").append(attempted.get());
+		json.append(",\"completed\":").append(completed.get());
+		json.append(",\"skipped\":").append(skipped.get());
+		json.append(",\"timeouts\":").append(timeouts.get());
+		json.append(",\"refused\":").append(refused.get());
+		json.append(",\"errors\":").append(errors.get());
+		json.append(",\"retransmits\":").append(retransmits.get());
+		json.append(",\"frames_per_s\":").append(format(completed.get() / elapsed));
+		json.append(",\"mb_per_s\":").append(format(bytes.get() / elapsed / (1024 * 1024)));
+		json.append(",\"latency_us\":{");
+		json.append("\"p50\":").append(latency.percentile(0.5));
+		json.append(",\"p90\":").append(latency.percentile(0.9));
+		json.append(",\"p99\":").append(latency.percentile(0.99));
+		json.append(",\"max\":").append(latency.getMax());
+		json.append(",\"mean\":").append(latency.getMean());
+		return json.append("}}").toString();
+	}
+
+	private static String format(double value) {
+		return String.format(Locale.ROOT, "%.3f", value);
+	}
+}
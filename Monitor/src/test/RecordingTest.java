@@ -0,0 +1,84 @@
+package test;
+
+import java.io.File;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.List;
+
+import code.Frame;
+import code.RecordingStore;
+
+// Records frames across several segments into a scratch directory, then
+// checks that find() and read() get the right frames back from the mapped
+// indexes: exact and in-between times, segment boundaries, equal
+// timestamps and times outside the recording. Exits with 1 on a mismatch.
+public class RecordingTest {
+	private static String CAMERA = "test";
+	private static long START = 1000000000000L;
+	private static long STEP = 61 * 1000;	//ms between frames, a segment is rotated every ten minutes
+	private static int FRAMES = 40;
+	private static int failures = 0;
+
+	public static void main(String[] args) throws IOException {
+		File dir = new File(System.getProperty("java.io.tmpdir"), "recording-test-" + System.nanoTime());
+		RecordingStore store = new RecordingStore(dir, Long.MAX_VALUE, Long.MAX_VALUE);
+
+		// Frame i carries its number, the last two share a timestamp
+		long[] times = new long[FRAMES];
+		for (int i = 0; i < FRAMES; i++) {
+			times[i] = (i == FRAMES - 1) ? times[i - 1] : START + i * STEP;
+			store.append(CAMERA, new Frame(CAMERA, times[i], new byte[] {(byte)0xFF, (byte)0xD8, (byte)i, (byte)0xFF, (byte)0xD9}));
+		}
+
+		int segments = new File(dir, CAMERA).list().length / 2;
+		check("segments", segments > 1, "only " + segments);
+
+		// Every frame at its own time, and between it and the next
+		for (int i = 0; i < FRAMES - 1; i++) {
+			expectFind(store, times[i], i == FRAMES - 2 ? FRAMES - 1 : i);
+			expectFind(store, times[i] + STEP / 2, i == FRAMES - 2 ? FRAMES - 1 : i);
+		}
+		expectFind(store, START - 1, -1);
+		expectFind(store, Long.MAX_VALUE, FRAMES - 1);
+
+		// Ranges within one segment, across boundaries, all of it and none of it
+		expectRead(store, times[3], times[5], 3, 5);
+		expectRead(store, times[3] + 1, times[25] - 1, 4, 24);
+		expectRead(store, Long.MIN_VALUE, Long.MAX_VALUE, 0, FRAMES - 1);
+		expectRead(store, times[FRAMES - 1], times[FRAMES - 1], FRAMES - 2, FRAMES - 1);
+		expectRead(store, START - 2 * STEP, START - STEP, 0, -1);
+
+		store.close();
+		for (File camera : dir.listFiles()) {
+			for (File file : camera.listFiles()) file.delete();
+			camera.delete();
+		}
+		dir.delete();
+
+		System.out.println(failures == 0 ? "Recording test passed." : failures + " recording checks failed.");
+		System.exit(failures == 0 ? 0 : 1);
+	}
+
+	// expected is the frame number, -1 for none
+	private static void expectFind(RecordingStore store, long timestamp, int expected) throws IOException {
+		Frame frame = store.find(CAMERA, timestamp);
+		int found = frame == null ? -1 : frame.getData()[2];
+		check("find " + timestamp, found == expected, "got frame " + found + ", expected " + expected);
+	}
+
+	// Frames first to last, none if last < first
+	private static void expectRead(RecordingStore store, long from, long to, int first, int last) throws IOException {
+		List<Integer> found = new ArrayList<Integer>();
+		store.read(CAMERA, from, to, frame -> found.add((int)frame.getData()[2]));
+		List<Integer> expected = new ArrayList<Integer>();
+		for (int i = first; i <= last; i++) expected.add(i);
+		check("read " + from + " to " + to, found.equals(expected), "got " + found + ", expected " + expected);
+	}
+
+	private static void check(String what, boolean ok, String detail) {
+		if (!ok) {
+			System.out.println(what + ": " + detail);
+			failures++;
+		}
+	}
+}
@@ -7,12 +7,17 @@ import java.awt.Image;
 import java.awt.Rectangle;
 import java.awt.Robot;
 import java.awt.image.BufferedImage;
+import java.io.ByteArrayOutputStream;
+import java.io.DataOutputStream;
 import java.io.IOException;
 import java.net.Socket;
 
 import javax.imageio.ImageIO;
 
+// Streams screenshots to the frame stream server the way the camera does,
+// a header before every JPEG on one connection.
 public class TestClient {
+	private static int FRAMES = 10;
 	Image newimg;
 	static BufferedImage bimg;
 	byte[] bytes;
@@ -22,10 +27,24 @@ public class TestClient {
 		int port = 6066;
 		try {
 			Socket client = new Socket(serverName, port);
+			DataOutputStream out = new DataOutputStream(client.getOutputStream());
 			Robot bot;
 			bot = new Robot();
-			bimg = bot.createScreenCapture(new Rectangle(13, 23, 640, 480));
-			ImageIO.write(bimg, "JPG", client.getOutputStream());
+			for (int seq = 0; seq < FRAMES; seq++) {
+				bimg = bot.createScreenCapture(new Rectangle(13, 23, 640, 480));
+				ByteArrayOutputStream jpeg = new ByteArrayOutputStream();
+				ImageIO.write(bimg, "JPG", jpeg);
+
+				// 'V' 'S' version header_length sequence frame_length
+				out.writeByte('V');
+				out.writeByte('S');
+				out.writeByte(1);
+				out.writeByte(12);
+				out.writeInt(seq);
+				out.writeInt(jpeg.size());
+				jpeg.writeTo(out);
+				out.flush();
+			}
 			client.close();
 		} catch (IOException | AWTException e) {
 			e.printStackTrace();